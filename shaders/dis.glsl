@@ -0,0 +1,36 @@
+// Helpers shared by the dense inverse search shaders, dis.comp and
+// densify.comp. Both run 64 invocations per workgroup.
+
+shared vec4 partialSums[64];
+
+float fetchLuma(sampler2D luma, ivec2 pos) {
+    return texelFetch(luma, clamp(pos, ivec2(0), textureSize(luma, 0) - 1), 0).r;
+}
+
+// Filtered by hand, since the pyramid's float format need not support
+// linear filtering
+float sampleLuma(sampler2D luma, vec2 pos) {
+    vec2 base = floor(pos);
+    vec2 weight = pos - base;
+    ivec2 texel = ivec2(base);
+    float top = mix(fetchLuma(luma, texel), fetchLuma(luma, texel + ivec2(1, 0)), weight.x);
+    float bottom = mix(fetchLuma(luma, texel + ivec2(0, 1)), fetchLuma(luma, texel + ivec2(1, 1)), weight.x);
+    return mix(top, bottom, weight.y);
+}
+
+// Sum of value over the workgroup, returned to every invocation. Must be
+// reached by all invocations.
+vec4 workgroupSum(vec4 value) {
+    uint thread = gl_LocalInvocationIndex;
+    partialSums[thread] = value;
+    barrier();
+    for (uint stride = 32u; stride > 0u; stride /= 2u) {
+        if (thread < stride) {
+            partialSums[thread] += partialSums[thread + stride];
+        }
+        barrier();
+    }
+    vec4 total = partialSums[0];
+    barrier();
+    return total;
+}
@@ -0,0 +1,48 @@
+// Packed motion field texel: one 32-bit word per block holding the vector
+// in signed 1/8 pixel fixed point (13 bits per component, +-512 pixels)
+// and the match confidence in the top 6 bits. R32_UINT storage is
+// supported everywhere, unlike the two-channel 16-bit formats.
+
+const float MOTION_SCALE = 8.0;
+
+uint packMotion(vec2 motion, float confidence) {
+    ivec2 steps = clamp(ivec2(round(motion * MOTION_SCALE)), ivec2(-4096), ivec2(4095));
+    uint level = uint(round(clamp(confidence, 0.0, 1.0) * 63.0));
+    return (uint(steps.x) & 0x1FFFu) | ((uint(steps.y) & 0x1FFFu) << 13) | (level << 26);
+}
+
+vec2 unpackMotion(uint texel) {
+    return vec2(bitfieldExtract(int(texel), 0, 13), bitfieldExtract(int(texel), 13, 13)) / MOTION_SCALE;
+}
+
+float unpackConfidence(uint texel) {
+    return float(texel >> 26) / 63.0;
+}
+
+// Vectors sit at block centres and are blended bilinearly in between, so
+// warps have no seams at block edges. position is in pixels of the frame
+// the field was estimated on.
+vec2 interpolateMotion(usampler2D field, vec2 position, float blockSize) {
+    ivec2 maxBlock = textureSize(field, 0) - 1;
+    vec2 blockPosition = position / blockSize - 0.5;
+    ivec2 base = ivec2(floor(blockPosition));
+    vec2 weight = blockPosition - vec2(base);
+
+    vec2 m00 = unpackMotion(texelFetch(field, clamp(base, ivec2(0), maxBlock), 0).r);
+    vec2 m10 = unpackMotion(texelFetch(field, clamp(base + ivec2(1, 0), ivec2(0), maxBlock), 0).r);
+    vec2 m01 = unpackMotion(texelFetch(field, clamp(base + ivec2(0, 1), ivec2(0), maxBlock), 0).r);
+    vec2 m11 = unpackMotion(texelFetch(field, clamp(base + ivec2(1, 1), ivec2(0), maxBlock), 0).r);
+    return mix(mix(m00, m10, weight.x), mix(m01, m11, weight.x), weight.y);
+}
+
+// Whether every block interpolateMotion blends at position holds an exact
+// match at zero motion, as the blocks of unchanged tiles do
+bool isStillMotion(usampler2D field, vec2 position, float blockSize) {
+    ivec2 maxBlock = textureSize(field, 0) - 1;
+    ivec2 base = ivec2(floor(position / blockSize - 0.5));
+    uint still = packMotion(vec2(0.0), 1.0);
+    return texelFetch(field, clamp(base, ivec2(0), maxBlock), 0).r == still &&
+           texelFetch(field, clamp(base + ivec2(1, 0), ivec2(0), maxBlock), 0).r == still &&
+           texelFetch(field, clamp(base + ivec2(0, 1), ivec2(0), maxBlock), 0).r == still &&
+           texelFetch(field, clamp(base + ivec2(1, 1), ivec2(0), maxBlock), 0).r == still;
+}
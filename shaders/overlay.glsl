@@ -0,0 +1,35 @@
+// Text overlay composited by the output pass. Each glyph instance places a
+// rectangle of the coverage atlas on the output image; the including
+// shader reserves bindings 2 and 3 for it.
+
+struct OverlayGlyph {
+    ivec4 dst;  // x, y, width, height in output pixels
+    ivec4 src;  // x, y in the atlas
+};
+
+layout(binding = 2) uniform sampler2D overlayAtlas;
+layout(std430, binding = 3) readonly buffer OverlayGlyphs {
+    OverlayGlyph glyphs[];
+} overlay;
+
+// bounds is (x0, y0, x1, y1) of the text block; pixels outside it return
+// before touching the glyph list
+vec4 applyOverlay(vec4 color, ivec2 pixel, ivec4 bounds, int glyphCount) {
+    if (glyphCount == 0 || any(lessThan(pixel, bounds.xy)) ||
+        any(greaterThanEqual(pixel, bounds.zw))) {
+        return color;
+    }
+
+    float coverage = 0.0;
+    for (int i = 0; i < glyphCount; i++) {
+        ivec4 dst = overlay.glyphs[i].dst;
+        ivec2 local = pixel - dst.xy;
+        if (all(greaterThanEqual(local, ivec2(0))) && all(lessThan(local, dst.zw))) {
+            coverage = max(coverage, texelFetch(overlayAtlas, overlay.glyphs[i].src.xy + local, 0).r);
+        }
+    }
+
+    // Darkened backing keeps white text readable on bright content
+    vec3 background = color.rgb * 0.5;
+    return vec4(mix(background, vec3(1.0), coverage), color.a);
+}
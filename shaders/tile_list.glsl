@@ -0,0 +1,69 @@
+// Tiles of the finest motion level that differ between two frames,
+// compacted by tiles.comp. Each list is preceded by the indirect dispatch
+// arguments that launch work over it; the including shader defines
+// TILE_LIST_BINDING. The head also holds the luma statistics of the pair
+// gathered by scene.comp.
+
+#define SCENE_BINS 64
+
+// Mean luma difference and share of pixels moved between histogram bins
+// above which two frames are taken to show different scenes. Both must be
+// exceeded: fast motion changes pixels but keeps the histogram, lighting
+// changes move the histogram but little else.
+const float SCENE_CUT_DIFFERENCE = 0.1;
+const float SCENE_CUT_HISTOGRAM = 0.3;
+
+layout(std430, binding = TILE_LIST_BINDING) buffer TileList {
+    // One workgroup per block of every searched tile
+    uint motionDispatch[3];
+    // One workgroup per changed tile
+    uint changedDispatch[3];
+    // One workgroup per unchanged tile
+    uint unchangedDispatch[3];
+    uint tileCount;
+    // Set by global.comp when the frames show different scenes
+    uint sceneCut;
+    // Translation of the whole frame found by global.comp, packed as in
+    // motion_field.glsl
+    uint globalMotion;
+    // Sum of absolute luma differences, in 1/255 steps
+    uint lumaDifference;
+    // Luma histograms of the previous and the current frame
+    uint histograms[2 * SCENE_BINS];
+    // Changed tiles from index 0, unchanged ones from tileCount and changed
+    // ones the global motion does not explain, which need a block search,
+    // from 2 * tileCount
+    uint tiles[];
+} tileList;
+
+bool detectSceneCut() {
+    uint pixels = 0u;
+    uint moved = 0u;
+    for (int bin = 0; bin < SCENE_BINS; bin++) {
+        uint previous = tileList.histograms[bin];
+        uint current = tileList.histograms[SCENE_BINS + bin];
+        pixels += previous;
+        moved += max(previous, current) - min(previous, current);
+    }
+    if (pixels == 0u) {
+        return false;
+    }
+
+    float difference = float(tileList.lumaDifference) / (255.0 * float(pixels));
+    float histogram = float(moved) / (2.0 * float(pixels));
+    return difference > SCENE_CUT_DIFFERENCE && histogram > SCENE_CUT_HISTOGRAM;
+}
+
+ivec2 tileCoord(uint tile, int tilesPerRow) {
+    return ivec2(tile % uint(tilesPerRow), tile / uint(tilesPerRow));
+}
+
+// Block handled by workgroup when one workgroup is launched per block of
+// the tiles listed for search, tileBlocks blocks per tile side
+ivec2 searchedBlock(uint workgroup, int tileBlocks, int tilesPerRow) {
+    uint blocksPerTile = uint(tileBlocks * tileBlocks);
+    uint local = workgroup % blocksPerTile;
+    uint searched = 2u * tileList.tileCount + workgroup / blocksPerTile;
+    ivec2 tile = tileCoord(tileList.tiles[searched], tilesPerRow);
+    return tile * tileBlocks + ivec2(local % uint(tileBlocks), local / uint(tileBlocks));
+}
@@ -0,0 +1,131 @@
+#include "block_motion_estimator.hpp"
+#include <algorithm>
+
+bool BlockMotionEstimator::CreateLayouts() {
+    std::vector<VkDescriptorSetLayoutBinding> bindings = {
+        {
+            .binding = 0,
+            .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT
+        },
+        {
+            .binding = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT
+        },
+        {
+            .binding = 2,
+            .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT
+        },
+        {
+            .binding = 3,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT
+        },
+        {
+            .binding = 4,
+            .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT
+        },
+        {
+            .binding = 5,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT
+        }
+    };
+
+    return m_bindings.Create(bindings, sizeof(MotionPushConstants));
+}
+
+void BlockMotionEstimator::Cleanup() {
+    m_pipeline = VK_NULL_HANDLE;
+    m_bindings.Destroy();
+}
+
+uint32_t BlockMotionEstimator::GetPartialCount() {
+    auto& vulkan = VulkanContext::Get();
+    if (!vulkan.HasSubgroupArithmetic()) {
+        return kThreads;
+    }
+    return std::max(kThreads / vulkan.GetSubgroupSize(), 1u);
+}
+
+uint32_t BlockMotionEstimator::GetSharedMemorySize(int32_t blockSize, int32_t searchRadius) {
+    uint32_t block = static_cast<uint32_t>(blockSize);
+    uint32_t radius = static_cast<uint32_t>(std::min(searchRadius, kMaxLevelSearchRadius));
+    uint32_t window = block + 2 * radius;
+    uint32_t slots = kPredictors + (2 * radius + 1) * (2 * radius + 1) + 1;
+    return (block * block + window * window) * sizeof(float) +
+           kPredictors * 2 * sizeof(int32_t) +
+           slots * (GetPartialCount() + 1) * sizeof(float);
+}
+
+bool BlockMotionEstimator::FitsDevice(int32_t blockSize, int32_t searchRadius) {
+    const auto& limits = VulkanContext::Get().GetDeviceProperties().limits;
+    return GetSharedMemorySize(blockSize, searchRadius) <= limits.maxComputeSharedMemorySize;
+}
+
+ComputePipelineDesc BlockMotionEstimator::PipelineDesc() const {
+    bool subgroups = VulkanContext::Get().HasSubgroupArithmetic();
+    return {
+        .name = "motion",
+        .code = subgroups ? shaders::kMotionSubgroup : shaders::kMotion,
+        .codeSize = subgroups ? sizeof(shaders::kMotionSubgroup) : sizeof(shaders::kMotion),
+        .layout = m_bindings.GetPipelineLayout(),
+        // The workgroup is one block, so motionWorkgroup only applies to
+        // the pyramid
+        .specialization = {
+            static_cast<uint32_t>(m_params.motionBlockSize),
+            static_cast<uint32_t>(std::min(m_params.motionSearchRadius, kMaxLevelSearchRadius)),
+            // Only read by the subgroup variant
+            GetPartialCount()
+        }
+    };
+}
+
+void BlockMotionEstimator::RequestPipelines(const KernelParams& params) {
+    m_params = params;
+    m_pipeline = VK_NULL_HANDLE;
+    PipelineCache::Get().RequestComputePipeline(PipelineDesc());
+}
+
+bool BlockMotionEstimator::ResolvePipelines() {
+    if (m_pipeline == VK_NULL_HANDLE) {
+        m_pipeline = PipelineCache::Get().GetComputePipeline(PipelineDesc());
+    }
+    return m_pipeline != VK_NULL_HANDLE;
+}
+
+void BlockMotionEstimator::RecordLevel(VkCommandBuffer commandBuffer, const MotionLevel& level) {
+    DescriptorInfo descriptors[6]{};
+    descriptors[0].image.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+    descriptors[0].image.imageView = level.previousLuma.view;
+    descriptors[0].image.sampler = level.sampler;
+    descriptors[1].image.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+    descriptors[1].image.imageView = level.currentLuma.view;
+    descriptors[1].image.sampler = level.sampler;
+    descriptors[2].image.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+    descriptors[2].image.imageView = level.coarse.view;
+    descriptors[2].image.sampler = level.sampler;
+    descriptors[3].image.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+    descriptors[3].image.imageView = level.output.vectors.view;
+    descriptors[4].image.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+    descriptors[4].image.imageView = level.temporal.view;
+    descriptors[4].image.sampler = level.sampler;
+    descriptors[5].buffer = {level.tiles.tileList, 0, VK_WHOLE_SIZE};
+
+    MotionPushConstants motionConstants = MakePushConstants(level);
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipeline);
+    m_bindings.Bind(commandBuffer, descriptors);
+    vkCmdPushConstants(commandBuffer, m_bindings.GetPipelineLayout(),
+        VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(motionConstants), &motionConstants);
+    DispatchBlocks(commandBuffer, level);
+}
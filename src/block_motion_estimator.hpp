@@ -0,0 +1,42 @@
+#pragma once
+#include "frame_manager.hpp"
+
+// Block matching in shaders/motion.comp: each block tests predictors from
+// the coarser level and the previous search, then refines the best one.
+// The refinement radius is picked per block from the speed and confidence
+// of its previous vector, between kLevelSearchRadius for still or
+// untracked blocks and kMaxLevelSearchRadius for fast ones and the
+// coarsest level. One workgroup per block.
+class BlockMotionEstimator : public MotionEstimator {
+public:
+    // Its 7x7 window is the widest whose candidates one 64-invocation
+    // workgroup can total in a single pass
+    static constexpr int32_t kMaxLevelSearchRadius = 3;
+    // Invocations per workgroup of motion.comp
+    static constexpr uint32_t kThreads = 64;
+
+    // Shared memory of motion.comp: the block and window tiles, and the
+    // per-candidate partial sums, which only shrink with subgroups
+    static uint32_t GetSharedMemorySize(int32_t blockSize, int32_t searchRadius);
+    static bool FitsDevice(int32_t blockSize, int32_t searchRadius);
+
+    const char* GetName() const override { return "block"; }
+    bool CreateLayouts() override;
+    void Cleanup() override;
+
+    void RequestPipelines(const KernelParams& params) override;
+    bool ResolvePipelines() override;
+
+    void RecordLevel(VkCommandBuffer commandBuffer, const MotionLevel& level) override;
+
+private:
+    static constexpr uint32_t kPredictors = 7;
+
+    // Partial sums kept per candidate, one per subgroup or per invocation
+    static uint32_t GetPartialCount();
+    ComputePipelineDesc PipelineDesc() const;
+
+    VkPipeline m_pipeline = VK_NULL_HANDLE;
+    DescriptorBinder m_bindings;
+    KernelParams m_params;
+};
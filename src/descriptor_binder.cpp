@@ -0,0 +1,238 @@
+#include "descriptor_binder.hpp"
+
+bool DescriptorBinder::Create(const std::vector<VkDescriptorSetLayoutBinding>& bindings,
+                              uint32_t pushConstantSize) {
+    auto& vulkan = VulkanContext::Get();
+    auto device = vulkan.GetDevice();
+
+    if (bindings.size() > kMaxBindings) {
+        LOG_ERROR("Too many descriptor bindings: ", bindings.size());
+        return false;
+    }
+
+    m_usePush = vulkan.HasPushDescriptors();
+    m_bindingCount = static_cast<uint32_t>(bindings.size());
+    for (uint32_t i = 0; i < m_bindingCount; i++) {
+        m_types[i] = bindings[i].descriptorType;
+    }
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = m_bindingCount;
+    layoutInfo.pBindings = bindings.data();
+    if (m_usePush) {
+        layoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR;
+    }
+
+    if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &m_setLayout) != VK_SUCCESS) {
+        LOG_ERROR("Failed to create descriptor set layout");
+        return false;
+    }
+
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = pushConstantSize;
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &m_setLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = pushConstantSize > 0 ? 1 : 0;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+    if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &m_pipelineLayout) != VK_SUCCESS) {
+        LOG_ERROR("Failed to create pipeline layout");
+        return false;
+    }
+
+    std::array<VkDescriptorUpdateTemplateEntry, kMaxBindings> entries{};
+    for (uint32_t i = 0; i < m_bindingCount; i++) {
+        entries[i].dstBinding = bindings[i].binding;
+        entries[i].dstArrayElement = 0;
+        entries[i].descriptorCount = 1;
+        entries[i].descriptorType = bindings[i].descriptorType;
+        entries[i].offset = i * sizeof(DescriptorInfo);
+        entries[i].stride = sizeof(DescriptorInfo);
+    }
+
+    VkDescriptorUpdateTemplateCreateInfo templateInfo{};
+    templateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO;
+    templateInfo.descriptorUpdateEntryCount = m_bindingCount;
+    templateInfo.pDescriptorUpdateEntries = entries.data();
+    if (m_usePush) {
+        templateInfo.templateType = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_PUSH_DESCRIPTORS_KHR;
+        templateInfo.pipelineBindPoint = VK_PIPELINE_BIND_POINT_COMPUTE;
+        templateInfo.pipelineLayout = m_pipelineLayout;
+        templateInfo.set = 0;
+    } else {
+        templateInfo.templateType = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET;
+        templateInfo.descriptorSetLayout = m_setLayout;
+    }
+
+    if (vkCreateDescriptorUpdateTemplate(device, &templateInfo, nullptr, &m_template) != VK_SUCCESS) {
+        LOG_ERROR("Failed to create descriptor update template");
+        return false;
+    }
+
+    if (!m_usePush) {
+        for (const auto& binding : bindings) {
+            m_poolSizes.push_back({
+                .type = binding.descriptorType,
+                .descriptorCount = binding.descriptorCount * kFallbackSets
+            });
+        }
+        if (!CreateFallbackSets()) {
+            LOG_ERROR("Failed to create fallback descriptor sets");
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool DescriptorBinder::CreateFallbackSets() {
+    auto device = VulkanContext::Get().GetDevice();
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = static_cast<uint32_t>(m_poolSizes.size());
+    poolInfo.pPoolSizes = m_poolSizes.data();
+    poolInfo.maxSets = kFallbackSets;
+
+    VkDescriptorPool pool;
+    if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &pool) != VK_SUCCESS) {
+        return false;
+    }
+    m_pools.push_back(pool);
+
+    std::array<VkDescriptorSetLayout, kFallbackSets> layouts;
+    layouts.fill(m_setLayout);
+
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = pool;
+    allocInfo.descriptorSetCount = kFallbackSets;
+    allocInfo.pSetLayouts = layouts.data();
+
+    std::array<VkDescriptorSet, kFallbackSets> sets;
+    if (vkAllocateDescriptorSets(device, &allocInfo, sets.data()) != VK_SUCCESS) {
+        return false;
+    }
+
+    for (VkDescriptorSet set : sets) {
+        m_sets.push_back({.set = set});
+    }
+
+    return true;
+}
+
+bool DescriptorBinder::Matches(const CachedSet& cached, const DescriptorInfo* infos) const {
+    if (!cached.valid) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < m_bindingCount; i++) {
+        const auto& a = cached.contents[i];
+        const auto& b = infos[i];
+        switch (m_types[i]) {
+            case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+            case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+                if (a.buffer.buffer != b.buffer.buffer ||
+                    a.buffer.offset != b.buffer.offset ||
+                    a.buffer.range != b.buffer.range) {
+                    return false;
+                }
+                break;
+            default:
+                if (a.image.sampler != b.image.sampler ||
+                    a.image.imageView != b.image.imageView ||
+                    a.image.imageLayout != b.image.imageLayout) {
+                    return false;
+                }
+                break;
+        }
+    }
+
+    return true;
+}
+
+void DescriptorBinder::Bind(VkCommandBuffer commandBuffer, const DescriptorInfo* infos) {
+    auto& vulkan = VulkanContext::Get();
+
+    if (m_usePush) {
+        vulkan.CmdPushDescriptorSetWithTemplate(commandBuffer, m_template,
+            m_pipelineLayout, 0, infos);
+        return;
+    }
+
+    // The bound resources rarely change between frames, so most binds hit a
+    // set that already holds exactly these descriptors and need no update.
+    // On a miss the least recently used set whose last submission has
+    // completed is rewritten, or a new pool is added if there is none.
+    uint64_t completed = vulkan.GetCompletedSerial();
+    CachedSet* target = nullptr;
+    CachedSet* reusable = nullptr;
+    for (auto& cached : m_sets) {
+        if (Matches(cached, infos)) {
+            target = &cached;
+            break;
+        }
+        if (cached.serial <= completed && (!reusable || cached.lastUse < reusable->lastUse)) {
+            reusable = &cached;
+        }
+    }
+
+    if (!target) {
+        if (!reusable) {
+            size_t first = m_sets.size();
+            if (!CreateFallbackSets()) {
+                LOG_ERROR("Failed to grow fallback descriptor sets");
+                return;
+            }
+            LOG_INFO("Descriptor sets in flight exceeded ", first, ", added ", kFallbackSets, " more");
+            reusable = &m_sets[first];
+        }
+
+        target = reusable;
+        vkUpdateDescriptorSetWithTemplate(vulkan.GetDevice(), target->set, m_template, infos);
+        for (uint32_t i = 0; i < m_bindingCount; i++) {
+            target->contents[i] = infos[i];
+        }
+        target->valid = true;
+    }
+
+    target->lastUse = ++m_useCounter;
+    target->serial = vulkan.GetPendingSerial();
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+        m_pipelineLayout, 0, 1, &target->set, 0, nullptr);
+}
+
+void DescriptorBinder::Destroy() {
+    auto device = VulkanContext::Get().GetDevice();
+
+    if (m_template != VK_NULL_HANDLE) {
+        vkDestroyDescriptorUpdateTemplate(device, m_template, nullptr);
+        m_template = VK_NULL_HANDLE;
+    }
+
+    for (VkDescriptorPool pool : m_pools) {
+        vkDestroyDescriptorPool(device, pool, nullptr);
+    }
+    m_pools.clear();
+    m_poolSizes.clear();
+
+    if (m_pipelineLayout != VK_NULL_HANDLE) {
+        vkDestroyPipelineLayout(device, m_pipelineLayout, nullptr);
+        m_pipelineLayout = VK_NULL_HANDLE;
+    }
+
+    if (m_setLayout != VK_NULL_HANDLE) {
+        vkDestroyDescriptorSetLayout(device, m_setLayout, nullptr);
+        m_setLayout = VK_NULL_HANDLE;
+    }
+
+    m_sets.clear();
+    m_useCounter = 0;
+    m_bindingCount = 0;
+}
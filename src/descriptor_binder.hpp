@@ -0,0 +1,60 @@
+#pragma once
+#include <array>
+#include <vector>
+#include "vulkan_context.hpp"
+
+// One descriptor's worth of data. Callers fill an array of these in binding
+// order and hand it to DescriptorBinder::Bind, which feeds it straight to a
+// descriptor update template.
+union DescriptorInfo {
+    VkDescriptorImageInfo image;
+    VkDescriptorBufferInfo buffer;
+};
+
+// Owns the set layout, pipeline layout and update template for a compute
+// pipeline with a single descriptor set and one push constant range.
+// Bindings are pushed with VK_KHR_push_descriptor when the device has it,
+// otherwise they go to a cache of sets that are only rewritten once the
+// submission that last used them has completed, growing by another pool
+// when every set is still in flight.
+class DescriptorBinder {
+public:
+    static constexpr uint32_t kMaxBindings = 8;
+    // Sets per fallback pool
+    static constexpr uint32_t kFallbackSets = 16;
+
+    bool Create(const std::vector<VkDescriptorSetLayoutBinding>& bindings,
+                uint32_t pushConstantSize);
+    void Destroy();
+
+    void Bind(VkCommandBuffer commandBuffer, const DescriptorInfo* infos);
+
+    VkDescriptorSetLayout GetSetLayout() const { return m_setLayout; }
+    VkPipelineLayout GetPipelineLayout() const { return m_pipelineLayout; }
+
+private:
+    struct CachedSet {
+        VkDescriptorSet set = VK_NULL_HANDLE;
+        std::array<DescriptorInfo, kMaxBindings> contents{};
+        uint64_t lastUse = 0;
+        // VulkanContext submission serial of the last bind
+        uint64_t serial = 0;
+        bool valid = false;
+    };
+
+    bool CreateFallbackSets();
+    bool Matches(const CachedSet& cached, const DescriptorInfo* infos) const;
+
+    VkDescriptorSetLayout m_setLayout = VK_NULL_HANDLE;
+    VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
+    VkDescriptorUpdateTemplate m_template = VK_NULL_HANDLE;
+    std::vector<VkDescriptorPool> m_pools;
+    std::vector<VkDescriptorPoolSize> m_poolSizes;
+    bool m_usePush = false;
+
+    std::array<VkDescriptorType, kMaxBindings> m_types{};
+    uint32_t m_bindingCount = 0;
+
+    std::vector<CachedSet> m_sets;
+    uint64_t m_useCounter = 0;
+};
@@ -0,0 +1,221 @@
+#include "dis_motion_estimator.hpp"
+
+bool DisMotionEstimator::CreateLayouts() {
+    // Same inputs as the block search, writing patch flows instead
+    std::vector<VkDescriptorSetLayoutBinding> searchBindings = {
+        {
+            .binding = 0,
+            .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT
+        },
+        {
+            .binding = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT
+        },
+        {
+            .binding = 2,
+            .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT
+        },
+        {
+            .binding = 3,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT
+        },
+        {
+            .binding = 4,
+            .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT
+        },
+        {
+            .binding = 5,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT
+        }
+    };
+
+    std::vector<VkDescriptorSetLayoutBinding> densifyBindings = {
+        {
+            .binding = 0,
+            .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT
+        },
+        {
+            .binding = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT
+        },
+        {
+            .binding = 2,
+            .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT
+        },
+        {
+            .binding = 3,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT
+        },
+        {
+            .binding = 4,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT
+        }
+    };
+
+    return m_searchBindings.Create(searchBindings, sizeof(MotionPushConstants)) &&
+           m_densifyBindings.Create(densifyBindings, sizeof(MotionPushConstants));
+}
+
+bool DisMotionEstimator::FitsDevice(int32_t blockSize) {
+    const auto& limits = VulkanContext::Get().GetDeviceProperties().limits;
+    return GetSharedMemorySize(blockSize) <= limits.maxComputeSharedMemorySize;
+}
+
+void DisMotionEstimator::Cleanup() {
+    DestroyResources();
+    m_searchPipeline = VK_NULL_HANDLE;
+    m_densifyPipeline = VK_NULL_HANDLE;
+    m_searchBindings.Destroy();
+    m_densifyBindings.Destroy();
+}
+
+ComputePipelineDesc DisMotionEstimator::SearchPipelineDesc() const {
+    return {
+        .name = "dis",
+        .code = shaders::kDis,
+        .codeSize = sizeof(shaders::kDis),
+        .layout = m_searchBindings.GetPipelineLayout(),
+        .specialization = {
+            static_cast<uint32_t>(m_params.motionBlockSize),
+            kIterations
+        }
+    };
+}
+
+ComputePipelineDesc DisMotionEstimator::DensifyPipelineDesc() const {
+    return {
+        .name = "densify",
+        .code = shaders::kDensify,
+        .codeSize = sizeof(shaders::kDensify),
+        .layout = m_densifyBindings.GetPipelineLayout(),
+        .specialization = {
+            static_cast<uint32_t>(m_params.motionBlockSize)
+        }
+    };
+}
+
+void DisMotionEstimator::RequestPipelines(const KernelParams& params) {
+    m_params = params;
+    m_searchPipeline = VK_NULL_HANDLE;
+    m_densifyPipeline = VK_NULL_HANDLE;
+    PipelineCache::Get().RequestComputePipeline(SearchPipelineDesc());
+    PipelineCache::Get().RequestComputePipeline(DensifyPipelineDesc());
+}
+
+bool DisMotionEstimator::ResolvePipelines() {
+    auto& cache = PipelineCache::Get();
+
+    if (m_searchPipeline == VK_NULL_HANDLE) {
+        m_searchPipeline = cache.GetComputePipeline(SearchPipelineDesc());
+    }
+
+    if (m_densifyPipeline == VK_NULL_HANDLE) {
+        m_densifyPipeline = cache.GetComputePipeline(DensifyPipelineDesc());
+    }
+
+    return m_searchPipeline != VK_NULL_HANDLE && m_densifyPipeline != VK_NULL_HANDLE;
+}
+
+bool DisMotionEstimator::CreateResources(const std::vector<MotionField>& fields) {
+    auto& frameManager = FrameManager::Get();
+
+    m_patchFlows.resize(fields.size());
+    for (size_t level = 0; level < fields.size(); level++) {
+        const Frame& vectors = fields[level].vectors;
+        if (!frameManager.CreateFrame(m_patchFlows[level], vectors.width, vectors.height,
+                                      FrameManager::kMotionFormat)) {
+            DestroyResources();
+            return false;
+        }
+    }
+    return true;
+}
+
+void DisMotionEstimator::DestroyResources() {
+    for (auto& flow : m_patchFlows) {
+        FrameManager::Get().DestroyFrame(flow);
+    }
+    m_patchFlows.clear();
+}
+
+void DisMotionEstimator::RecordLevel(VkCommandBuffer commandBuffer, const MotionLevel& level) {
+    auto& frameManager = FrameManager::Get();
+    const Frame& patches = m_patchFlows[level.index];
+    MotionPushConstants motionConstants = MakePushConstants(level);
+
+    // Source stage covers the densify pass of the last search reading it
+    frameManager.TransitionImage(commandBuffer, patches.image,
+        VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+        0, VK_ACCESS_SHADER_WRITE_BIT,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+    DescriptorInfo searchDescriptors[6]{};
+    searchDescriptors[0].image.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+    searchDescriptors[0].image.imageView = level.previousLuma.view;
+    searchDescriptors[0].image.sampler = level.sampler;
+    searchDescriptors[1].image.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+    searchDescriptors[1].image.imageView = level.currentLuma.view;
+    searchDescriptors[1].image.sampler = level.sampler;
+    searchDescriptors[2].image.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+    searchDescriptors[2].image.imageView = level.coarse.view;
+    searchDescriptors[2].image.sampler = level.sampler;
+    searchDescriptors[3].image.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+    searchDescriptors[3].image.imageView = patches.view;
+    searchDescriptors[4].image.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+    searchDescriptors[4].image.imageView = level.temporal.view;
+    searchDescriptors[4].image.sampler = level.sampler;
+    searchDescriptors[5].buffer = {level.tiles.tileList, 0, VK_WHOLE_SIZE};
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_searchPipeline);
+    m_searchBindings.Bind(commandBuffer, searchDescriptors);
+    vkCmdPushConstants(commandBuffer, m_searchBindings.GetPipelineLayout(),
+        VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(motionConstants), &motionConstants);
+    DispatchBlocks(commandBuffer, level);
+
+    frameManager.TransitionImage(commandBuffer, patches.image,
+        VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL,
+        VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+    DescriptorInfo densifyDescriptors[5]{};
+    densifyDescriptors[0].image.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+    densifyDescriptors[0].image.imageView = level.previousLuma.view;
+    densifyDescriptors[0].image.sampler = level.sampler;
+    densifyDescriptors[1].image.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+    densifyDescriptors[1].image.imageView = level.currentLuma.view;
+    densifyDescriptors[1].image.sampler = level.sampler;
+    densifyDescriptors[2].image.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+    densifyDescriptors[2].image.imageView = patches.view;
+    densifyDescriptors[2].image.sampler = level.sampler;
+    densifyDescriptors[3].image.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+    densifyDescriptors[3].image.imageView = level.output.vectors.view;
+    densifyDescriptors[4].buffer = {level.tiles.tileList, 0, VK_WHOLE_SIZE};
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_densifyPipeline);
+    m_densifyBindings.Bind(commandBuffer, densifyDescriptors);
+    vkCmdPushConstants(commandBuffer, m_densifyBindings.GetPipelineLayout(),
+        VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(motionConstants), &motionConstants);
+    DispatchBlocks(commandBuffer, level);
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include "frame_manager.hpp"
+
+// Dense inverse search: shaders/dis.comp runs a fixed number of inverse
+// compositional Lucas-Kanade iterations on one patch per block, twice the
+// block size, and shaders/densify.comp blends the overlapping patch flows
+// into the block field by how well each explains the block. Vectors are
+// sub-pixel at every level and the cost per block does not depend on the
+// content.
+class DisMotionEstimator : public MotionEstimator {
+public:
+    static constexpr uint32_t kIterations = 4;
+
+    // Shared memory of dis.comp: the patch template with a one-pixel apron
+    // and the 64-entry reduction scratch of dis.glsl
+    static uint32_t GetSharedMemorySize(int32_t blockSize) {
+        uint32_t apron = 2 * static_cast<uint32_t>(blockSize) + 2;
+        return apron * apron * sizeof(float) + 64 * 4 * sizeof(float);
+    }
+    static bool FitsDevice(int32_t blockSize);
+
+    const char* GetName() const override { return "dis"; }
+    bool CreateLayouts() override;
+    void Cleanup() override;
+
+    void RequestPipelines(const KernelParams& params) override;
+    bool ResolvePipelines() override;
+
+    bool CreateResources(const std::vector<MotionField>& fields) override;
+    void DestroyResources() override;
+
+    void RecordLevel(VkCommandBuffer commandBuffer, const MotionLevel& level) override;
+
+private:
+    ComputePipelineDesc SearchPipelineDesc() const;
+    ComputePipelineDesc DensifyPipelineDesc() const;
+
+    VkPipeline m_searchPipeline = VK_NULL_HANDLE;
+    DescriptorBinder m_searchBindings;
+    VkPipeline m_densifyPipeline = VK_NULL_HANDLE;
+    DescriptorBinder m_densifyBindings;
+    KernelParams m_params;
+
+    // Flow of each level's patches, one per block
+    std::vector<Frame> m_patchFlows;
+};
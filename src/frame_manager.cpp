@@ -1,68 +1,376 @@
 #include "frame_manager.hpp"
+#include <algorithm>
+#include <cstddef>
+#include "block_motion_estimator.hpp"
+#include "dis_motion_estimator.hpp"
+
+namespace {
+
+// Blocks across the shortest side of the coarsest level; smaller levels
+// have too little structure left to match
+constexpr uint32_t kMinLevelBlocks = 4;
+// Approximate side of a culling tile; tiles hold a whole number of blocks
+constexpr uint32_t kTileTargetSize = 32;
+
+// Local size of shaders/scene.comp and shaders/profile.comp
+constexpr uint32_t kStatisticsWorkgroupSize = 16;
+
+// Matches the tile modes of shaders/interpolate.comp
+constexpr int32_t kTilesChanged = 1;
+constexpr int32_t kTilesUnchanged = 2;
+
+} // namespace
+
+bool ParseMotionEngine(const std::string& name, MotionEngine& engine) {
+    if (name == "block") {
+        engine = MotionEngine::Block;
+    } else if (name == "dis") {
+        engine = MotionEngine::Dis;
+    } else {
+        return false;
+    }
+    return true;
+}
 
-bool FrameManager::Initialize(uint32_t width, uint32_t height) {
+const char* GetMotionEngineName(MotionEngine engine) {
+    return engine == MotionEngine::Dis ? "dis" : "block";
+}
+
+MotionPushConstants MotionEstimator::MakePushConstants(const MotionLevel& level) {
+    const MotionField& tiles = level.tiles;
+    return {
+        .imageSize = {static_cast<int32_t>(level.currentLuma.width),
+                     static_cast<int32_t>(level.currentLuma.height)},
+        .hasPredictor = level.hasPredictor ? 1 : 0,
+        .hasTemporal = level.hasTemporal ? 1 : 0,
+        .tileBlocks = level.culled ? static_cast<int32_t>(tiles.tileSize / tiles.blockSize) : 0,
+        .tilesPerRow = static_cast<int32_t>(tiles.tilesPerRow)
+    };
+}
+
+void MotionEstimator::DispatchBlocks(VkCommandBuffer commandBuffer, const MotionLevel& level) {
+    if (level.culled) {
+        vkCmdDispatchIndirect(commandBuffer, level.tiles.tileList, offsetof(TileListHeader, motionDispatch));
+    } else {
+        vkCmdDispatch(commandBuffer, level.output.vectors.width, level.output.vectors.height, 1);
+    }
+}
+
+bool FrameManager::Initialize(uint32_t width, uint32_t height, const KernelParams& params) {
     if (!CreateCommandPool()) {
         LOG_ERROR("Failed to create command pool");
         return false;
     }
 
+    if (!CreateSampler()) {
+        LOG_ERROR("Failed to create sampler");
+        return false;
+    }
+
+    m_motionEstimators[static_cast<size_t>(MotionEngine::Block)] = std::make_unique<BlockMotionEstimator>();
+    m_motionEstimators[static_cast<size_t>(MotionEngine::Dis)] = std::make_unique<DisMotionEstimator>();
+
+    if (!CreatePyramidLayout() || !CreateSceneLayout() || !CreateProfileLayout() ||
+        !CreateGlobalLayout() || !CreateTileLayout() || !CreateInterpolateLayout()) {
+        LOG_ERROR("Failed to create interpolation pipeline layouts");
+        return false;
+    }
+
+    for (auto& estimator : m_motionEstimators) {
+        if (!estimator->CreateLayouts()) {
+            LOG_ERROR("Failed to create ", estimator->GetName(), " motion pipeline layouts");
+            return false;
+        }
+    }
+
+    // Pipelines are built on worker threads; Scaler::Initialize waits for
+    // them together with its own so nothing is compiled on the first frame
+    if (!SetKernelParams(params)) {
+        LOG_ERROR("Invalid kernel parameters");
+        return false;
+    }
+
     LOG_INFO("FrameManager initialized successfully");
     return true;
 }
 
-bool FrameManager::LoadShaderFile(const std::string& filename, std::vector<char>& buffer) {
-    std::ifstream file(filename, std::ios::ate | std::ios::binary);
-    if (!file.is_open()) {
-        LOG_ERROR("Failed to open shader file: ", filename);
+bool FrameManager::ValidateKernelParams(const KernelParams& params) {
+    const auto& limits = VulkanContext::Get().GetDeviceProperties().limits;
+
+    for (const auto& workgroup : {params.scaleWorkgroup, params.motionWorkgroup,
+                                  params.interpolateWorkgroup}) {
+        if (workgroup.x == 0 || workgroup.y == 0 ||
+            workgroup.x > limits.maxComputeWorkGroupSize[0] ||
+            workgroup.y > limits.maxComputeWorkGroupSize[1] ||
+            workgroup.x * workgroup.y > limits.maxComputeWorkGroupInvocations) {
+            LOG_ERROR("Workgroup size ", workgroup.x, "x", workgroup.y,
+                      " not supported by device (max ", limits.maxComputeWorkGroupInvocations,
+                      " invocations)");
+            return false;
+        }
+    }
+
+    if (params.lanczosRadius < 1 || params.lanczosRadius > 8) {
+        LOG_ERROR("Lanczos radius must be between 1 and 8");
         return false;
     }
 
-    size_t fileSize = (size_t)file.tellg();
-    buffer.resize(fileSize);
+    if (params.motionBlockSize < 1 || params.motionBlockSize > 32) {
+        LOG_ERROR("Motion block size must be between 1 and 32");
+        return false;
+    }
+
+    if (params.motionSearchRadius < 0 || params.motionSearchRadius > 64) {
+        LOG_ERROR("Motion search radius must be between 0 and 64");
+        return false;
+    }
+
+    if (params.motionEngine == MotionEngine::Dis && !DisMotionEstimator::FitsDevice(params.motionBlockSize)) {
+        LOG_ERROR("Motion block size ", params.motionBlockSize, " needs ",
+                  DisMotionEstimator::GetSharedMemorySize(params.motionBlockSize),
+                  " bytes of shared memory with the dis engine (max ",
+                  limits.maxComputeSharedMemorySize, ")");
+        return false;
+    }
+
+    if (params.motionEngine == MotionEngine::Block &&
+        !BlockMotionEstimator::FitsDevice(params.motionBlockSize, params.motionSearchRadius)) {
+        LOG_ERROR("Motion block size ", params.motionBlockSize, " needs ",
+                  BlockMotionEstimator::GetSharedMemorySize(params.motionBlockSize,
+                                                            params.motionSearchRadius),
+                  " bytes of shared memory with the block engine (max ",
+                  limits.maxComputeSharedMemorySize, ")");
+        return false;
+    }
+
+    return true;
+}
+
+bool FrameManager::SetKernelParams(const KernelParams& params) {
+    if (!ValidateKernelParams(params)) {
+        return false;
+    }
+
+    m_kernelParams = params;
+    m_pyramidPipeline = VK_NULL_HANDLE;
+    m_scenePipeline = VK_NULL_HANDLE;
+    m_profilePipeline = VK_NULL_HANDLE;
+    m_globalPipeline = VK_NULL_HANDLE;
+    m_tilePipeline = VK_NULL_HANDLE;
+    m_interpolatePipeline = VK_NULL_HANDLE;
+
+    PipelineCache::Get().RequestComputePipeline(PyramidPipelineDesc());
+    PipelineCache::Get().RequestComputePipeline(ScenePipelineDesc());
+    PipelineCache::Get().RequestComputePipeline(ProfilePipelineDesc());
+    PipelineCache::Get().RequestComputePipeline(GlobalPipelineDesc());
+    PipelineCache::Get().RequestComputePipeline(TilePipelineDesc());
+    GetMotionEstimator().RequestPipelines(params);
+    PipelineCache::Get().RequestComputePipeline(InterpolatePipelineDesc());
+    return true;
+}
+
+ComputePipelineDesc FrameManager::PyramidPipelineDesc() const {
+    return {
+        .name = "pyramid",
+        .code = shaders::kPyramid,
+        .codeSize = sizeof(shaders::kPyramid),
+        .layout = m_pyramidBindings.GetPipelineLayout(),
+        .specialization = {
+            m_kernelParams.motionWorkgroup.x,
+            m_kernelParams.motionWorkgroup.y
+        }
+    };
+}
+
+ComputePipelineDesc FrameManager::ScenePipelineDesc() const {
+    return {
+        .name = "scene",
+        .code = shaders::kScene,
+        .codeSize = sizeof(shaders::kScene),
+        .layout = m_sceneBindings.GetPipelineLayout()
+    };
+}
+
+ComputePipelineDesc FrameManager::ProfilePipelineDesc() const {
+    return {
+        .name = "profile",
+        .code = shaders::kProfile,
+        .codeSize = sizeof(shaders::kProfile),
+        .layout = m_profileBindings.GetPipelineLayout()
+    };
+}
+
+ComputePipelineDesc FrameManager::GlobalPipelineDesc() const {
+    return {
+        .name = "global",
+        .code = shaders::kGlobal,
+        .codeSize = sizeof(shaders::kGlobal),
+        .layout = m_globalBindings.GetPipelineLayout()
+    };
+}
+
+ComputePipelineDesc FrameManager::TilePipelineDesc() const {
+    return {
+        .name = "tiles",
+        .code = shaders::kTiles,
+        .codeSize = sizeof(shaders::kTiles),
+        .layout = m_tileBindings.GetPipelineLayout()
+    };
+}
+
+ComputePipelineDesc FrameManager::InterpolatePipelineDesc() const {
+    return {
+        .name = "interpolate",
+        .code = shaders::kInterpolate,
+        .codeSize = sizeof(shaders::kInterpolate),
+        .layout = m_interpolateBindings.GetPipelineLayout(),
+        .specialization = {
+            m_kernelParams.interpolateWorkgroup.x,
+            m_kernelParams.interpolateWorkgroup.y
+        }
+    };
+}
+
+bool FrameManager::ResolvePipelines() {
+    auto& cache = PipelineCache::Get();
+
+    if (m_pyramidPipeline == VK_NULL_HANDLE) {
+        m_pyramidPipeline = cache.GetComputePipeline(PyramidPipelineDesc());
+    }
+
+    if (m_scenePipeline == VK_NULL_HANDLE) {
+        m_scenePipeline = cache.GetComputePipeline(ScenePipelineDesc());
+    }
+
+    if (m_profilePipeline == VK_NULL_HANDLE) {
+        m_profilePipeline = cache.GetComputePipeline(ProfilePipelineDesc());
+    }
 
-    file.seekg(0);
-    file.read(buffer.data(), fileSize);
-    file.close();
+    if (m_globalPipeline == VK_NULL_HANDLE) {
+        m_globalPipeline = cache.GetComputePipeline(GlobalPipelineDesc());
+    }
+
+    if (m_tilePipeline == VK_NULL_HANDLE) {
+        m_tilePipeline = cache.GetComputePipeline(TilePipelineDesc());
+    }
+
+    bool motionResolved = GetMotionEstimator().ResolvePipelines();
+
+    if (m_interpolatePipeline == VK_NULL_HANDLE) {
+        m_interpolatePipeline = cache.GetComputePipeline(InterpolatePipelineDesc());
+    }
+
+    return m_pyramidPipeline != VK_NULL_HANDLE && m_scenePipeline != VK_NULL_HANDLE &&
+           m_profilePipeline != VK_NULL_HANDLE && m_globalPipeline != VK_NULL_HANDLE &&
+           m_tilePipeline != VK_NULL_HANDLE && motionResolved &&
+           m_interpolatePipeline != VK_NULL_HANDLE;
+}
+
+MotionEstimator& FrameManager::GetMotionEstimator() const {
+    return *m_motionEstimators[static_cast<size_t>(m_kernelParams.motionEngine)];
+}
+
+bool FrameManager::CreateFrame(Frame& frame, uint32_t width, uint32_t height, VkFormat format) {
+    if (!CreateFrameImage(frame, width, height, 1, format)) {
+        return false;
+    }
+
+    if (!CreateImageView(frame, VK_IMAGE_VIEW_TYPE_2D, 0, 1, frame.view)) {
+        LOG_ERROR("Failed to create frame image view");
+        DestroyFrame(frame);
+        return false;
+    }
 
     return true;
 }
 
-bool FrameManager::CreateFrame(Frame& frame, uint32_t width, uint32_t height) {
+bool FrameManager::CreateMotionField(MotionField& field, uint32_t width, uint32_t height) {
+    field.blockSize = static_cast<uint32_t>(m_kernelParams.motionBlockSize);
+    return CreateFrame(field.vectors, (width + field.blockSize - 1) / field.blockSize,
+                       (height + field.blockSize - 1) / field.blockSize, kMotionFormat);
+}
+
+bool FrameManager::CreateTileList(MotionField& field, uint32_t width, uint32_t height) {
+    field.tileSize = field.blockSize * ((kTileTargetSize + field.blockSize - 1) / field.blockSize);
+    field.tilesPerRow = (width + field.tileSize - 1) / field.tileSize;
+    field.tileRows = (height + field.tileSize - 1) / field.tileSize;
+
+    // Each of the three lists can hold every tile
+    VkDeviceSize size = sizeof(TileListHeader) + 3 * sizeof(uint32_t) * field.tilesPerRow * field.tileRows;
+    return VulkanContext::Get().CreateBuffer(size,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+        VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, field.tileList, field.tileListMemory);
+}
+
+void FrameManager::DestroyMotionField(MotionField& field) {
+    DestroyFrame(field.vectors);
+    if (field.tileList != VK_NULL_HANDLE) {
+        VulkanContext::Get().DestroyBuffer(field.tileList, field.tileListMemory);
+    }
+    field = MotionField{};
+}
+
+bool FrameManager::CreateFrameArray(Frame& frame, uint32_t width, uint32_t height, uint32_t layers,
+                                    VkFormat format) {
+    if (!CreateFrameImage(frame, width, height, layers, format)) {
+        return false;
+    }
+
+    if (!CreateImageView(frame, VK_IMAGE_VIEW_TYPE_2D_ARRAY, 0, layers, frame.view)) {
+        LOG_ERROR("Failed to create frame array view");
+        DestroyFrame(frame);
+        return false;
+    }
+
+    return true;
+}
+
+bool FrameManager::CreateFrameImage(Frame& frame, uint32_t width, uint32_t height, uint32_t layers,
+                                    VkFormat format) {
     auto& vulkan = VulkanContext::Get();
 
     frame.width = width;
     frame.height = height;
+    frame.format = format;
+    frame.layers = layers;
 
     VkImageUsageFlags usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | 
                              VK_IMAGE_USAGE_TRANSFER_DST_BIT |
-                             VK_IMAGE_USAGE_STORAGE_BIT |
                              VK_IMAGE_USAGE_SAMPLED_BIT;
 
+    // BGRA frames hold captured pixels and are only ever sampled; storage
+    // support for them is optional
+    VkFormatProperties formatProperties;
+    vkGetPhysicalDeviceFormatProperties(vulkan.GetPhysicalDevice(), format, &formatProperties);
+    if (formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT) {
+        usage |= VK_IMAGE_USAGE_STORAGE_BIT;
+    }
+
     if (!vulkan.CreateImage(width, height, frame.format, usage,
                            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-                           frame.image, frame.memory)) {
+                           frame.image, frame.memory, layers)) {
         LOG_ERROR("Failed to create frame image");
         return false;
     }
 
+    return true;
+}
+
+bool FrameManager::CreateImageView(const Frame& frame, VkImageViewType type, uint32_t baseLayer,
+                                   uint32_t layerCount, VkImageView& view) {
     VkImageViewCreateInfo viewInfo{};
     viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
     viewInfo.image = frame.image;
-    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.viewType = type;
     viewInfo.format = frame.format;
     viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
     viewInfo.subresourceRange.baseMipLevel = 0;
     viewInfo.subresourceRange.levelCount = 1;
-    viewInfo.subresourceRange.baseArrayLayer = 0;
-    viewInfo.subresourceRange.layerCount = 1;
-
-    if (vkCreateImageView(vulkan.GetDevice(), &viewInfo, nullptr, &frame.view) != VK_SUCCESS) {
-        LOG_ERROR("Failed to create frame image view");
-        DestroyFrame(frame);
-        return false;
-    }
+    viewInfo.subresourceRange.baseArrayLayer = baseLayer;
+    viewInfo.subresourceRange.layerCount = layerCount;
 
-    return true;
+    return vkCreateImageView(VulkanContext::Get().GetDevice(), &viewInfo, nullptr, &view) == VK_SUCCESS;
 }
 
 void FrameManager::DestroyFrame(Frame& frame) {
@@ -213,183 +521,581 @@ void FrameManager::DestroyStagingBuffer(VkBuffer buffer, VkDeviceMemory memory)
     vulkan.DestroyBuffer(buffer, memory);
 }
 
-bool FrameManager::InterpolateFrames(const Frame& previous, const Frame& current, 
-                                   Frame& output, float factor) {
-    if (!m_motionPipeline || !m_interpolatePipeline) {
-        if (!CreateMotionPipeline() || !CreateInterpolatePipeline() || !CreateDescriptorSets()) {
-            LOG_ERROR("Failed to create interpolation pipelines");
+bool FrameManager::InterpolateFrames(const Frame& previous, const Frame& current,
+                                     Frame& output, float firstFactor, float factorStep) {
+    if (!ResolvePipelines()) {
+        LOG_ERROR("Interpolation pipelines not available");
+        return false;
+    }
+
+    VkCommandBuffer commandBuffer = BeginSingleTimeCommands();
+
+    TransitionImage(commandBuffer, output.image,
+        VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+        0, VK_ACCESS_SHADER_WRITE_BIT,
+        VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+    const MotionField* motion = RecordMotionEstimation(commandBuffer, previous, current);
+    if (motion) {
+        RecordInterpolation(commandBuffer, previous, current, *motion, output, firstFactor, factorStep);
+    }
+
+    EndSingleTimeCommands(commandBuffer);
+    return motion != nullptr;
+}
+
+uint32_t FrameManager::PyramidLevelCount(uint32_t width, uint32_t height) const {
+    int32_t levelRadius = std::min(m_kernelParams.motionSearchRadius, MotionEstimator::kLevelSearchRadius);
+    int32_t reach = levelRadius;
+    uint32_t levels = 1;
+    uint32_t minLevelSize = kMinLevelBlocks * static_cast<uint32_t>(m_kernelParams.motionBlockSize);
+    while (reach < m_kernelParams.motionSearchRadius && (std::min(width, height) >> levels) >= minLevelSize) {
+        reach = reach * 2 + levelRadius;
+        levels++;
+    }
+    return levels;
+}
+
+bool FrameManager::EnsureMotionResources(uint32_t width, uint32_t height) {
+    uint32_t levels = PyramidLevelCount(width, height);
+    const auto& cached = m_pyramids[0].levels;
+    if (cached.size() == levels && cached[0].width == width && cached[0].height == height) {
+        return true;
+    }
+
+    DestroyMotionResources();
+    LOG_INFO("Creating ", levels, "-level motion pyramid for ", width, "x", height);
+
+    for (auto& fields : m_motionFields) {
+        fields.resize(levels);
+    }
+    for (auto& pyramid : m_pyramids) {
+        pyramid.levels.resize(levels);
+    }
+
+    for (uint32_t level = 0; level < levels; level++) {
+        uint32_t levelWidth = std::max(width >> level, 1u);
+        uint32_t levelHeight = std::max(height >> level, 1u);
+
+        for (auto& pyramid : m_pyramids) {
+            if (!CreateFrame(pyramid.levels[level], levelWidth, levelHeight, VK_FORMAT_R32_SFLOAT)) {
+                LOG_ERROR("Failed to create luma pyramid level");
+                DestroyMotionResources();
+                return false;
+            }
+        }
+
+        for (auto& fields : m_motionFields) {
+            if (!CreateMotionField(fields[level], levelWidth, levelHeight) ||
+                (level == 0 && !CreateTileList(fields[level], levelWidth, levelHeight))) {
+                LOG_ERROR("Failed to create motion pyramid level");
+                DestroyMotionResources();
+                return false;
+            }
+        }
+    }
+
+    VkDeviceSize profileSize = 2 * sizeof(uint32_t) * (width + height);
+    if (!VulkanContext::Get().CreateBuffer(profileSize,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_profileBuffer, m_profileMemory)) {
+        LOG_ERROR("Failed to create luma profile buffer");
+        DestroyMotionResources();
+        return false;
+    }
+
+    // Every engine gets its resources so switching needs no reallocation
+    for (auto& estimator : m_motionEstimators) {
+        if (!estimator->CreateResources(m_motionFields[0])) {
+            LOG_ERROR("Failed to create ", estimator->GetName(), " motion resources");
+            DestroyMotionResources();
             return false;
         }
     }
 
-    // Create motion vectors frame
-    Frame motionVectors;
-    if (!CreateFrame(motionVectors, current.width, current.height)) {
-        LOG_ERROR("Failed to create motion vectors frame");
+    return true;
+}
+
+void FrameManager::DestroyMotionResources() {
+    for (auto& pyramid : m_pyramids) {
+        for (auto& level : pyramid.levels) {
+            DestroyFrame(level);
+        }
+        pyramid = LumaPyramid{};
+    }
+
+    for (auto& fields : m_motionFields) {
+        for (auto& level : fields) {
+            DestroyMotionField(level);
+        }
+        fields.clear();
+    }
+    m_hasTemporalFields = false;
+
+    for (auto& estimator : m_motionEstimators) {
+        if (estimator) {
+            estimator->DestroyResources();
+        }
+    }
+
+    if (m_profileBuffer != VK_NULL_HANDLE) {
+        VulkanContext::Get().DestroyBuffer(m_profileBuffer, m_profileMemory);
+        m_profileBuffer = VK_NULL_HANDLE;
+        m_profileMemory = VK_NULL_HANDLE;
+    }
+}
+
+const LumaPyramid* FrameManager::FindPyramid(const Frame& frame) const {
+    if (frame.serial == 0) {
+        return nullptr;
+    }
+
+    for (const auto& pyramid : m_pyramids) {
+        if (pyramid.source == frame.image && pyramid.serial == frame.serial) {
+            return &pyramid;
+        }
+    }
+    return nullptr;
+}
+
+const LumaPyramid& FrameManager::PreparePyramid(VkCommandBuffer commandBuffer, const Frame& frame,
+                                                const LumaPyramid* keep) {
+    if (const LumaPyramid* cached = FindPyramid(frame)) {
+        return *cached;
+    }
+
+    LumaPyramid& pyramid = keep == &m_pyramids[0] ? m_pyramids[1] : m_pyramids[0];
+    pyramid.source = frame.image;
+    pyramid.serial = frame.serial;
+
+    for (size_t level = 0; level < pyramid.levels.size(); level++) {
+        const Frame& target = pyramid.levels[level];
+        // Source stage covers earlier motion searches reading this pyramid
+        TransitionImage(commandBuffer, target.image,
+            VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+            0, VK_ACCESS_SHADER_WRITE_BIT,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+        if (level == 0) {
+            RecordPyramidLevel(commandBuffer, frame, target, true);
+        } else {
+            RecordPyramidLevel(commandBuffer, pyramid.levels[level - 1], target, false);
+        }
+
+        TransitionImage(commandBuffer, target.image,
+            VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL,
+            VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+    }
+
+    return pyramid;
+}
+
+void FrameManager::RecordPyramidLevel(VkCommandBuffer commandBuffer, const Frame& source,
+                                      const Frame& level, bool colorInput) {
+    DescriptorInfo descriptors[2]{};
+    descriptors[0].image.imageLayout = colorInput ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+                                                  : VK_IMAGE_LAYOUT_GENERAL;
+    descriptors[0].image.imageView = source.view;
+    descriptors[0].image.sampler = m_pointSampler;
+    descriptors[1].image.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+    descriptors[1].image.imageView = level.view;
+
+    PyramidPushConstants pyramidConstants{
+        .outputSize = {static_cast<int32_t>(level.width),
+                       static_cast<int32_t>(level.height)},
+        .colorInput = colorInput ? 1 : 0
+    };
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pyramidPipeline);
+    m_pyramidBindings.Bind(commandBuffer, descriptors);
+    vkCmdPushConstants(commandBuffer, m_pyramidBindings.GetPipelineLayout(),
+        VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pyramidConstants), &pyramidConstants);
+
+    const auto& group = m_kernelParams.motionWorkgroup;
+    vkCmdDispatch(commandBuffer,
+        (level.width + group.x - 1) / group.x,
+        (level.height + group.y - 1) / group.y, 1);
+}
+
+bool FrameManager::RecordPyramid(VkCommandBuffer commandBuffer, const Frame& frame) {
+    if (!EnsureMotionResources(frame.width, frame.height)) {
         return false;
     }
 
-    // Motion estimation
-    VkDescriptorImageInfo prevInfo{};
-    prevInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-    prevInfo.imageView = previous.view;
-    prevInfo.sampler = m_sampler;
+    for (auto& pyramid : m_pyramids) {
+        pyramid.source = VK_NULL_HANDLE;
+        pyramid.serial = 0;
+    }
+    PreparePyramid(commandBuffer, frame, nullptr);
+    return true;
+}
+
+const MotionField* FrameManager::RecordMotionEstimation(VkCommandBuffer commandBuffer, const Frame& previous,
+                                                        const Frame& current) {
+    if (!EnsureMotionResources(current.width, current.height)) {
+        return nullptr;
+    }
+
+    // In a stream, the previous frame's pyramid was built as the current
+    // one of the last pair
+    const LumaPyramid& previousPyramid = PreparePyramid(commandBuffer, previous, FindPyramid(current));
+    const LumaPyramid& currentPyramid = PreparePyramid(commandBuffer, current, &previousPyramid);
+
+    // The fields of the last search seed this one and are kept until the
+    // next, so the returned field stays valid while it is being used
+    const auto& temporal = m_motionFields[m_motionFieldSet];
+    m_motionFieldSet ^= 1;
+    const auto& fields = m_motionFields[m_motionFieldSet];
+
+    for (const auto& field : fields) {
+        TransitionImage(commandBuffer, field.vectors.image,
+            VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+            0, VK_ACCESS_SHADER_WRITE_BIT,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+    }
+
+    // Fills the finest field for unchanged tiles and lists the changed ones
+    RecordTileClassification(commandBuffer, previous, current, previousPyramid, currentPyramid,
+                             fields[0]);
+
+    // Coarsest level first; each level refines the field of the one below.
+    // Coarse levels are searched everywhere, since their blocks span tiles.
+    MotionEstimator& estimator = GetMotionEstimator();
+    uint32_t levels = static_cast<uint32_t>(fields.size());
+    for (uint32_t level = levels; level-- > 0;) {
+        const Frame& output = fields[level].vectors;
+        bool hasPredictor = level + 1 < levels;
+
+        estimator.RecordLevel(commandBuffer, {
+            .index = level,
+            .previousLuma = previousPyramid.levels[level],
+            .currentLuma = currentPyramid.levels[level],
+            .coarse = hasPredictor ? fields[level + 1].vectors : output,
+            .temporal = m_hasTemporalFields ? temporal[level].vectors : output,
+            .output = fields[level],
+            .tiles = fields[0],
+            .hasPredictor = hasPredictor,
+            .hasTemporal = m_hasTemporalFields,
+            .culled = level == 0,
+            .sampler = m_pointSampler
+        });
+
+        TransitionImage(commandBuffer, output.image,
+            VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL,
+            VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+    }
 
-    VkDescriptorImageInfo currInfo{};
-    currInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-    currInfo.imageView = current.view;
-    currInfo.sampler = m_sampler;
+    m_hasTemporalFields = true;
+    return &fields[0];
+}
 
-    VkDescriptorImageInfo motionInfo{};
-    motionInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
-    motionInfo.imageView = motionVectors.view;
+void FrameManager::RecordTileClassification(VkCommandBuffer commandBuffer, const Frame& previous,
+                                            const Frame& current, const LumaPyramid& previousPyramid,
+                                            const LumaPyramid& currentPyramid, const MotionField& field) {
+    // The list was last read by the work launched over it two searches ago
+    GlobalBarrier(commandBuffer, 0, VK_ACCESS_TRANSFER_WRITE_BIT,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+        VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+    TileListHeader header{
+        .motionDispatch = {0, 1, 1},
+        .changedDispatch = {0, 1, 1},
+        .unchangedDispatch = {0, 1, 1},
+        .tileCount = field.tilesPerRow * field.tileRows
+    };
+    vkCmdUpdateBuffer(commandBuffer, field.tileList, 0, sizeof(header), &header);
+    vkCmdFillBuffer(commandBuffer, m_profileBuffer, 0, VK_WHOLE_SIZE, 0);
+
+    GlobalBarrier(commandBuffer, VK_ACCESS_TRANSFER_WRITE_BIT,
+        VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+        VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+    // Scene statistics from the coarsest level, cheap at any frame size
+    const Frame& previousLuma = previousPyramid.levels.back();
+    const Frame& currentLuma = currentPyramid.levels.back();
+
+    DescriptorInfo sceneDescriptors[3]{};
+    sceneDescriptors[0].image.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+    sceneDescriptors[0].image.imageView = previousLuma.view;
+    sceneDescriptors[0].image.sampler = m_pointSampler;
+    sceneDescriptors[1].image.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+    sceneDescriptors[1].image.imageView = currentLuma.view;
+    sceneDescriptors[1].image.sampler = m_pointSampler;
+    sceneDescriptors[2].buffer = {field.tileList, 0, VK_WHOLE_SIZE};
+
+    ScenePushConstants sceneConstants{
+        .imageSize = {static_cast<int32_t>(currentLuma.width),
+                     static_cast<int32_t>(currentLuma.height)}
+    };
 
-    VkDescriptorImageInfo outputInfo{};
-    outputInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
-    outputInfo.imageView = output.view;
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_scenePipeline);
+    m_sceneBindings.Bind(commandBuffer, sceneDescriptors);
+    vkCmdPushConstants(commandBuffer, m_sceneBindings.GetPipelineLayout(),
+        VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(sceneConstants), &sceneConstants);
+    vkCmdDispatch(commandBuffer,
+        (currentLuma.width + kStatisticsWorkgroupSize - 1) / kStatisticsWorkgroupSize,
+        (currentLuma.height + kStatisticsWorkgroupSize - 1) / kStatisticsWorkgroupSize, 1);
+
+    // Profiles at full resolution, so the global motion is exact to the
+    // pixel before its sub-pixel refinement
+    const Frame& previousFull = previousPyramid.levels.front();
+    const Frame& currentFull = currentPyramid.levels.front();
+
+    DescriptorInfo profileDescriptors[3]{};
+    profileDescriptors[0].image.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+    profileDescriptors[0].image.imageView = previousFull.view;
+    profileDescriptors[0].image.sampler = m_pointSampler;
+    profileDescriptors[1].image.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+    profileDescriptors[1].image.imageView = currentFull.view;
+    profileDescriptors[1].image.sampler = m_pointSampler;
+    profileDescriptors[2].buffer = {m_profileBuffer, 0, VK_WHOLE_SIZE};
+
+    ProfilePushConstants profileConstants{
+        .imageSize = {static_cast<int32_t>(currentFull.width),
+                     static_cast<int32_t>(currentFull.height)}
+    };
 
-    // Create descriptor writes for motion estimation
-    std::vector<VkWriteDescriptorSet> motionDescriptorWrites = {
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_profilePipeline);
+    m_profileBindings.Bind(commandBuffer, profileDescriptors);
+    vkCmdPushConstants(commandBuffer, m_profileBindings.GetPipelineLayout(),
+        VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(profileConstants), &profileConstants);
+    vkCmdDispatch(commandBuffer,
+        (currentFull.width + kStatisticsWorkgroupSize - 1) / kStatisticsWorkgroupSize,
+        (currentFull.height + kStatisticsWorkgroupSize - 1) / kStatisticsWorkgroupSize, 1);
+
+    GlobalBarrier(commandBuffer, VK_ACCESS_SHADER_WRITE_BIT,
+        VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+    DescriptorInfo globalDescriptors[2]{};
+    globalDescriptors[0].buffer = {m_profileBuffer, 0, VK_WHOLE_SIZE};
+    globalDescriptors[1].buffer = {field.tileList, 0, VK_WHOLE_SIZE};
+
+    GlobalMotionPushConstants globalConstants{
+        .imageSize = {static_cast<int32_t>(currentFull.width),
+                     static_cast<int32_t>(currentFull.height)},
+        .searchRadius = m_kernelParams.motionSearchRadius
+    };
+
+    // A single workgroup matches the profiles
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_globalPipeline);
+    m_globalBindings.Bind(commandBuffer, globalDescriptors);
+    vkCmdPushConstants(commandBuffer, m_globalBindings.GetPipelineLayout(),
+        VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(globalConstants), &globalConstants);
+    vkCmdDispatch(commandBuffer, 1, 1, 1);
+
+    GlobalBarrier(commandBuffer, VK_ACCESS_SHADER_WRITE_BIT,
+        VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+    DescriptorInfo descriptors[4]{};
+    descriptors[0].image.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    descriptors[0].image.imageView = previous.view;
+    descriptors[0].image.sampler = m_pointSampler;
+    descriptors[1].image.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    descriptors[1].image.imageView = current.view;
+    descriptors[1].image.sampler = m_pointSampler;
+    descriptors[2].image.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+    descriptors[2].image.imageView = field.vectors.view;
+    descriptors[3].buffer = {field.tileList, 0, VK_WHOLE_SIZE};
+
+    TilePushConstants tileConstants{
+        .imageSize = {static_cast<int32_t>(current.width),
+                     static_cast<int32_t>(current.height)},
+        .tileSize = static_cast<int32_t>(field.tileSize),
+        .blockSize = static_cast<int32_t>(field.blockSize)
+    };
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_tilePipeline);
+    m_tileBindings.Bind(commandBuffer, descriptors);
+    vkCmdPushConstants(commandBuffer, m_tileBindings.GetPipelineLayout(),
+        VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(tileConstants), &tileConstants);
+    vkCmdDispatch(commandBuffer, field.tilesPerRow, field.tileRows, 1);
+
+    // Lists and zeroed blocks feed both indirect dispatches and shaders
+    GlobalBarrier(commandBuffer, VK_ACCESS_SHADER_WRITE_BIT,
+        VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT);
+}
+
+void FrameManager::RecordInterpolation(VkCommandBuffer commandBuffer, const Frame& previous,
+                                       const Frame& current, const MotionField& motion,
+                                       Frame& output, float firstFactor, float factorStep) {
+    DescriptorInfo descriptors[5]{};
+    descriptors[0].image.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    descriptors[0].image.imageView = previous.view;
+    descriptors[0].image.sampler = m_sampler;
+    descriptors[1].image.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    descriptors[1].image.imageView = current.view;
+    descriptors[1].image.sampler = m_sampler;
+    descriptors[2].image.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+    descriptors[2].image.imageView = motion.vectors.view;
+    descriptors[2].image.sampler = m_pointSampler;
+    descriptors[3].image.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+    descriptors[3].image.imageView = output.view;
+    descriptors[4].buffer = {motion.tileList, 0, VK_WHOLE_SIZE};
+
+    InterpolatePushConstants interpolateConstants{
+        .imageSize = {static_cast<int32_t>(current.width),
+                     static_cast<int32_t>(current.height)},
+        .firstFactor = firstFactor,
+        .factorStep = factorStep,
+        .layerCount = static_cast<int32_t>(output.layers),
+        .blockSize = static_cast<int32_t>(motion.blockSize),
+        .tileMode = kTilesChanged,
+        .tileSize = static_cast<int32_t>(motion.tileSize),
+        .tilesPerRow = static_cast<int32_t>(motion.tilesPerRow)
+    };
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_interpolatePipeline);
+    m_interpolateBindings.Bind(commandBuffer, descriptors);
+
+    // Changed tiles are generated, unchanged ones copied; the two cover
+    // disjoint pixels so no barrier is needed between them
+    vkCmdPushConstants(commandBuffer, m_interpolateBindings.GetPipelineLayout(),
+        VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(interpolateConstants), &interpolateConstants);
+    vkCmdDispatchIndirect(commandBuffer, motion.tileList, offsetof(TileListHeader, changedDispatch));
+
+    interpolateConstants.tileMode = kTilesUnchanged;
+    vkCmdPushConstants(commandBuffer, m_interpolateBindings.GetPipelineLayout(),
+        VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(interpolateConstants), &interpolateConstants);
+    vkCmdDispatchIndirect(commandBuffer, motion.tileList, offsetof(TileListHeader, unchangedDispatch));
+}
+
+void FrameManager::GlobalBarrier(VkCommandBuffer commandBuffer, VkAccessFlags srcAccess, VkAccessFlags dstAccess,
+                                 VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage) {
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = srcAccess;
+    barrier.dstAccessMask = dstAccess;
+
+    vkCmdPipelineBarrier(commandBuffer,
+        srcStage, dstStage,
+        0,
+        1, &barrier,
+        0, nullptr,
+        0, nullptr);
+}
+
+void FrameManager::TransitionImage(VkCommandBuffer commandBuffer, VkImage image,
+                                   VkImageLayout oldLayout, VkImageLayout newLayout,
+                                   VkAccessFlags srcAccess, VkAccessFlags dstAccess,
+                                   VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage) {
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout = oldLayout;
+    barrier.newLayout = newLayout;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = VK_REMAINING_ARRAY_LAYERS;
+    barrier.srcAccessMask = srcAccess;
+    barrier.dstAccessMask = dstAccess;
+
+    vkCmdPipelineBarrier(commandBuffer,
+        srcStage, dstStage,
+        0,
+        0, nullptr,
+        0, nullptr,
+        1, &barrier);
+}
+
+bool FrameManager::CreatePyramidLayout() {
+    std::vector<VkDescriptorSetLayoutBinding> bindings = {
         {
-            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-            .dstSet = m_motionDescriptorSet,
-            .dstBinding = 0,
-            .descriptorCount = 1,
+            .binding = 0,
             .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-            .pImageInfo = &prevInfo
-        },
-        {
-            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-            .dstSet = m_motionDescriptorSet,
-            .dstBinding = 1,
             .descriptorCount = 1,
-            .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-            .pImageInfo = &currInfo
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT
         },
         {
-            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-            .dstSet = m_motionDescriptorSet,
-            .dstBinding = 2,
-            .descriptorCount = 1,
+            .binding = 1,
             .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
-            .pImageInfo = &motionInfo
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT
         }
     };
 
-    // Create descriptor writes for interpolation
-    std::vector<VkWriteDescriptorSet> interpolateDescriptorWrites = {
+    return m_pyramidBindings.Create(bindings, sizeof(PyramidPushConstants));
+}
+
+bool FrameManager::CreateSceneLayout() {
+    std::vector<VkDescriptorSetLayoutBinding> bindings = {
         {
-            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-            .dstSet = m_interpolateDescriptorSet,
-            .dstBinding = 0,
+            .binding = 0,
+            .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
             .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT
+        },
+        {
+            .binding = 1,
             .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-            .pImageInfo = &prevInfo
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT
         },
         {
-            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-            .dstSet = m_interpolateDescriptorSet,
-            .dstBinding = 1,
+            .binding = 2,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
             .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT
+        }
+    };
+
+    return m_sceneBindings.Create(bindings, sizeof(ScenePushConstants));
+}
+
+bool FrameManager::CreateProfileLayout() {
+    std::vector<VkDescriptorSetLayoutBinding> bindings = {
+        {
+            .binding = 0,
             .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-            .pImageInfo = &currInfo
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT
         },
         {
-            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-            .dstSet = m_interpolateDescriptorSet,
-            .dstBinding = 2,
-            .descriptorCount = 1,
+            .binding = 1,
             .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-            .pImageInfo = &motionInfo
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT
         },
         {
-            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-            .dstSet = m_interpolateDescriptorSet,
-            .dstBinding = 3,
+            .binding = 2,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
             .descriptorCount = 1,
-            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
-            .pImageInfo = &outputInfo
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT
         }
     };
 
-    auto& vulkan = VulkanContext::Get();
-    
-    // Update motion descriptor sets
-    vkUpdateDescriptorSets(vulkan.GetDevice(), 
-        static_cast<uint32_t>(motionDescriptorWrites.size()), 
-        motionDescriptorWrites.data(), 0, nullptr);
-
-    // Execute motion estimation
-    VkCommandBuffer commandBuffer = BeginSingleTimeCommands();
-
-    struct MotionPushConstants {
-        int32_t imageSize[2];
-        int32_t blockSize;
-        float searchRadius;
-    } motionConstants{
-        .imageSize = {static_cast<int32_t>(current.width), 
-                     static_cast<int32_t>(current.height)},
-        .blockSize = 8,
-        .searchRadius = 16.0f
-    };
+    return m_profileBindings.Create(bindings, sizeof(ProfilePushConstants));
+}
 
-    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_motionPipeline);
-    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE,
-        m_motionPipelineLayout, 0, 1, &m_motionDescriptorSet, 0, nullptr);
-    vkCmdPushConstants(commandBuffer, m_motionPipelineLayout,
-        VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(motionConstants), &motionConstants);
-
-    uint32_t groupsX = (current.width + 15) / 16;
-    uint32_t groupsY = (current.height + 15) / 16;
-    vkCmdDispatch(commandBuffer, groupsX, groupsY, 1);
-
-    // Update interpolation descriptor sets
-    vkUpdateDescriptorSets(vulkan.GetDevice(),
-        static_cast<uint32_t>(interpolateDescriptorWrites.size()),
-        interpolateDescriptorWrites.data(), 0, nullptr);
-
-    struct InterpolatePushConstants {
-        float interpolationFactor;
-        int32_t imageSize[2];
-    } interpolateConstants{
-        .interpolationFactor = factor,
-        .imageSize = {static_cast<int32_t>(current.width),
-                     static_cast<int32_t>(current.height)}
+bool FrameManager::CreateGlobalLayout() {
+    std::vector<VkDescriptorSetLayoutBinding> bindings = {
+        {
+            .binding = 0,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT
+        },
+        {
+            .binding = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT
+        }
     };
 
-    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_interpolatePipeline);
-    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE,
-        m_interpolatePipelineLayout, 0, 1, &m_interpolateDescriptorSet, 0, nullptr);
-    vkCmdPushConstants(commandBuffer, m_interpolatePipelineLayout,
-        VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(interpolateConstants), &interpolateConstants);
-
-    vkCmdDispatch(commandBuffer, groupsX, groupsY, 1);
-
-    EndSingleTimeCommands(commandBuffer);
-    DestroyFrame(motionVectors);
-
-    return true;
+    return m_globalBindings.Create(bindings, sizeof(GlobalMotionPushConstants));
 }
 
-bool FrameManager::CreateMotionPipeline() {
-    auto& vulkan = VulkanContext::Get();
-    
-    // Load motion shader
-    std::vector<char> shaderCode;
-    if (!LoadShaderFile("shaders/motion.comp.spv", shaderCode)) {
-        return false;
-    }
-
-    VkShaderModuleCreateInfo createInfo{};
-    createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-    createInfo.codeSize = shaderCode.size();
-    createInfo.pCode = reinterpret_cast<const uint32_t*>(shaderCode.data());
-
-    if (vkCreateShaderModule(vulkan.GetDevice(), &createInfo, nullptr, &m_motionShader) != VK_SUCCESS) {
-        return false;
-    }
-
-    // Create descriptor set layout
+bool FrameManager::CreateTileLayout() {
     std::vector<VkDescriptorSetLayoutBinding> bindings = {
         {
             .binding = 0,
@@ -408,73 +1114,19 @@ bool FrameManager::CreateMotionPipeline() {
             .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
             .descriptorCount = 1,
             .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT
+        },
+        {
+            .binding = 3,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT
         }
     };
 
-    VkDescriptorSetLayoutCreateInfo layoutInfo{};
-    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
-    layoutInfo.pBindings = bindings.data();
-
-    if (vkCreateDescriptorSetLayout(vulkan.GetDevice(), &layoutInfo, nullptr, 
-                                  &m_motionDescriptorSetLayout) != VK_SUCCESS) {
-        return false;
-    }
-
-    // Create pipeline layout
-    VkPushConstantRange pushConstantRange{};
-    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
-    pushConstantRange.offset = 0;
-    pushConstantRange.size = sizeof(MotionPushConstants);
-
-    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
-    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    pipelineLayoutInfo.setLayoutCount = 1;
-    pipelineLayoutInfo.pSetLayouts = &m_motionDescriptorSetLayout;
-    pipelineLayoutInfo.pushConstantRangeCount = 1;
-    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
-
-    if (vkCreatePipelineLayout(vulkan.GetDevice(), &pipelineLayoutInfo, nullptr,
-                              &m_motionPipelineLayout) != VK_SUCCESS) {
-        return false;
-    }
-
-    // Create compute pipeline
-    VkComputePipelineCreateInfo pipelineInfo{};
-    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
-    pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
-    pipelineInfo.stage.module = m_motionShader;
-    pipelineInfo.stage.pName = "main";
-    pipelineInfo.layout = m_motionPipelineLayout;
-
-    if (vkCreateComputePipelines(vulkan.GetDevice(), VK_NULL_HANDLE, 1, &pipelineInfo,
-                                nullptr, &m_motionPipeline) != VK_SUCCESS) {
-        return false;
-    }
-
-    return true;
+    return m_tileBindings.Create(bindings, sizeof(TilePushConstants));
 }
 
-bool FrameManager::CreateInterpolatePipeline() {
-    auto& vulkan = VulkanContext::Get();
-    
-    // Load interpolate shader
-    std::vector<char> shaderCode;
-    if (!LoadShaderFile("shaders/interpolate.comp.spv", shaderCode)) {
-        return false;
-    }
-
-    VkShaderModuleCreateInfo createInfo{};
-    createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-    createInfo.codeSize = shaderCode.size();
-    createInfo.pCode = reinterpret_cast<const uint32_t*>(shaderCode.data());
-
-    if (vkCreateShaderModule(vulkan.GetDevice(), &createInfo, nullptr, &m_interpolateShader) != VK_SUCCESS) {
-        return false;
-    }
-
-    // Create descriptor set layout
+bool FrameManager::CreateInterpolateLayout() {
     std::vector<VkDescriptorSetLayoutBinding> bindings = {
         {
             .binding = 0,
@@ -499,55 +1151,23 @@ bool FrameManager::CreateInterpolatePipeline() {
             .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
             .descriptorCount = 1,
             .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT
+        },
+        {
+            .binding = 4,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT
         }
     };
 
-    VkDescriptorSetLayoutCreateInfo layoutInfo{};
-    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
-    layoutInfo.pBindings = bindings.data();
-
-    if (vkCreateDescriptorSetLayout(vulkan.GetDevice(), &layoutInfo, nullptr,
-                                  &m_interpolateDescriptorSetLayout) != VK_SUCCESS) {
-        return false;
-    }
-
-    // Create pipeline layout
-    VkPushConstantRange pushConstantRange{};
-    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
-    pushConstantRange.offset = 0;
-    pushConstantRange.size = sizeof(InterpolatePushConstants);
-
-    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
-    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    pipelineLayoutInfo.setLayoutCount = 1;
-    pipelineLayoutInfo.pSetLayouts = &m_interpolateDescriptorSetLayout;
-    pipelineLayoutInfo.pushConstantRangeCount = 1;
-    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
-
-    if (vkCreatePipelineLayout(vulkan.GetDevice(), &pipelineLayoutInfo, nullptr,
-                              &m_interpolatePipelineLayout) != VK_SUCCESS) {
-        return false;
-    }
-
-    // Create compute pipeline
-    VkComputePipelineCreateInfo pipelineInfo{};
-    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
-    pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
-    pipelineInfo.stage.module = m_interpolateShader;
-    pipelineInfo.stage.pName = "main";
-    pipelineInfo.layout = m_interpolatePipelineLayout;
-
-    if (vkCreateComputePipelines(vulkan.GetDevice(), VK_NULL_HANDLE, 1, &pipelineInfo,
-                                nullptr, &m_interpolatePipeline) != VK_SUCCESS) {
+    if (!m_interpolateBindings.Create(bindings, sizeof(InterpolatePushConstants))) {
         return false;
     }
 
     return true;
 }
 
-bool FrameManager::CreateDescriptorSets() {
+bool FrameManager::CreateSampler() {
     auto& vulkan = VulkanContext::Get();
 
     // make sampler if not exists
@@ -565,47 +1185,20 @@ bool FrameManager::CreateDescriptorSets() {
         }
     }
 
-    // make descriptor pool
-    std::vector<VkDescriptorPoolSize> poolSizes = {
-        {
-            .type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-            .descriptorCount = 6  // 2 for motion + 3 for interpolate
-        },
-        {
-            .type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
-            .descriptorCount = 2  // 1 for motion + 1 for interpolate
-        }
-    };
-
-    VkDescriptorPoolCreateInfo poolInfo{};
-    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
-    poolInfo.pPoolSizes = poolSizes.data();
-    poolInfo.maxSets = 2;  // One for motion, one for interpolate
-
-    if (vkCreateDescriptorPool(vulkan.GetDevice(), &poolInfo, nullptr, &m_descriptorPool) != VK_SUCCESS) {
-        return false;
-    }
-
-    std::vector<VkDescriptorSetLayout> layouts = {
-        m_motionDescriptorSetLayout,
-        m_interpolateDescriptorSetLayout
-    };
-
-    VkDescriptorSetAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-    allocInfo.descriptorPool = m_descriptorPool;
-    allocInfo.descriptorSetCount = static_cast<uint32_t>(layouts.size());
-    allocInfo.pSetLayouts = layouts.data();
+    if (m_pointSampler == VK_NULL_HANDLE) {
+        VkSamplerCreateInfo samplerInfo{};
+        samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+        samplerInfo.magFilter = VK_FILTER_NEAREST;
+        samplerInfo.minFilter = VK_FILTER_NEAREST;
+        samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
 
-    std::vector<VkDescriptorSet> sets(2);
-    if (vkAllocateDescriptorSets(vulkan.GetDevice(), &allocInfo, sets.data()) != VK_SUCCESS) {
-        return false;
+        if (vkCreateSampler(vulkan.GetDevice(), &samplerInfo, nullptr, &m_pointSampler) != VK_SUCCESS) {
+            return false;
+        }
     }
 
-    m_motionDescriptorSet = sets[0];
-    m_interpolateDescriptorSet = sets[1];
-
     return true;
 }
 
@@ -613,55 +1206,44 @@ void FrameManager::Cleanup() {
     auto& vulkan = VulkanContext::Get();
     auto device = vulkan.GetDevice();
 
-    if (m_sampler != VK_NULL_HANDLE) {
-        vkDestroySampler(device, m_sampler, nullptr);
-        m_sampler = VK_NULL_HANDLE;
-    }
-
-    if (m_motionPipeline != VK_NULL_HANDLE) {
-        vkDestroyPipeline(device, m_motionPipeline, nullptr);
-        m_motionPipeline = VK_NULL_HANDLE;
+    if (device) {
+        PipelineCache::Get().WaitForPipelines();
     }
 
-    if (m_interpolatePipeline != VK_NULL_HANDLE) {
-        vkDestroyPipeline(device, m_interpolatePipeline, nullptr);
-        m_interpolatePipeline = VK_NULL_HANDLE;
+    if (device) {
+        DestroyMotionResources();
     }
 
-    if (m_motionPipelineLayout != VK_NULL_HANDLE) {
-        vkDestroyPipelineLayout(device, m_motionPipelineLayout, nullptr);
-        m_motionPipelineLayout = VK_NULL_HANDLE;
-    }
-
-    if (m_interpolatePipelineLayout != VK_NULL_HANDLE) {
-        vkDestroyPipelineLayout(device, m_interpolatePipelineLayout, nullptr);
-        m_interpolatePipelineLayout = VK_NULL_HANDLE;
-    }
-
-    if (m_motionDescriptorSetLayout != VK_NULL_HANDLE) {
-        vkDestroyDescriptorSetLayout(device, m_motionDescriptorSetLayout, nullptr);
-        m_motionDescriptorSetLayout = VK_NULL_HANDLE;
-    }
-
-    if (m_interpolateDescriptorSetLayout != VK_NULL_HANDLE) {
-        vkDestroyDescriptorSetLayout(device, m_interpolateDescriptorSetLayout, nullptr);
-        m_interpolateDescriptorSetLayout = VK_NULL_HANDLE;
-    }
-
-    if (m_descriptorPool != VK_NULL_HANDLE) {
-        vkDestroyDescriptorPool(device, m_descriptorPool, nullptr);
-        m_descriptorPool = VK_NULL_HANDLE;
+    if (m_sampler != VK_NULL_HANDLE) {
+        vkDestroySampler(device, m_sampler, nullptr);
+        m_sampler = VK_NULL_HANDLE;
     }
 
-    if (m_motionShader != VK_NULL_HANDLE) {
-        vkDestroyShaderModule(device, m_motionShader, nullptr);
-        m_motionShader = VK_NULL_HANDLE;
+    if (m_pointSampler != VK_NULL_HANDLE) {
+        vkDestroySampler(device, m_pointSampler, nullptr);
+        m_pointSampler = VK_NULL_HANDLE;
     }
 
-    if (m_interpolateShader != VK_NULL_HANDLE) {
-        vkDestroyShaderModule(device, m_interpolateShader, nullptr);
-        m_interpolateShader = VK_NULL_HANDLE;
+    // Pipelines themselves are owned by the PipelineCache
+    m_pyramidPipeline = VK_NULL_HANDLE;
+    m_scenePipeline = VK_NULL_HANDLE;
+    m_profilePipeline = VK_NULL_HANDLE;
+    m_globalPipeline = VK_NULL_HANDLE;
+    m_tilePipeline = VK_NULL_HANDLE;
+    m_interpolatePipeline = VK_NULL_HANDLE;
+
+    m_pyramidBindings.Destroy();
+    m_sceneBindings.Destroy();
+    m_profileBindings.Destroy();
+    m_globalBindings.Destroy();
+    m_tileBindings.Destroy();
+    for (auto& estimator : m_motionEstimators) {
+        if (estimator) {
+            estimator->Cleanup();
+            estimator.reset();
+        }
     }
+    m_interpolateBindings.Destroy();
 
     if (m_commandPool != VK_NULL_HANDLE) {
         vkDestroyCommandPool(device, m_commandPool, nullptr);
@@ -3,8 +3,10 @@
 #include <memory>
 #include <vector>
 #include <string>
-#include <fstream>
 #include "vulkan_context.hpp"
+#include "descriptor_binder.hpp"
+#include "pipeline_cache.hpp"
+#include "shaders.hpp"
 
 struct Frame {
     VkImage image = VK_NULL_HANDLE;
@@ -13,37 +15,252 @@ struct Frame {
     uint32_t width = 0;
     uint32_t height = 0;
     VkFormat format = VK_FORMAT_R8G8B8A8_UNORM;
+    // Array frames: view covers every layer
+    uint32_t layers = 1;
+    // Bumped whenever new content is captured into the image, so data
+    // derived from it can be cached
+    uint64_t serial = 0;
 };
 
-struct MotionPushConstants {
+struct WorkgroupSize {
+    uint32_t x = 16;
+    uint32_t y = 16;
+
+    bool operator==(const WorkgroupSize&) const = default;
+};
+
+enum class MotionEngine {
+    // Block matching with predictors, one integer vector per block and level
+    Block,
+    // Dense inverse search: sub-pixel Lucas-Kanade per patch, densified
+    // into the block field
+    Dis
+};
+
+bool ParseMotionEngine(const std::string& name, MotionEngine& engine);
+const char* GetMotionEngineName(MotionEngine engine);
+
+// Compile-time kernel parameters, passed to the shaders as specialization
+// constants. Each distinct set of values gets its own pipeline variant.
+struct KernelParams {
+    WorkgroupSize scaleWorkgroup;
+    WorkgroupSize motionWorkgroup;
+    WorkgroupSize interpolateWorkgroup;
+    int32_t lanczosRadius = 3;
+    int32_t motionBlockSize = 8;
+    int32_t motionSearchRadius = 16;
+    MotionEngine motionEngine = MotionEngine::Block;
+
+    bool operator==(const KernelParams&) const = default;
+};
+
+struct PyramidPushConstants {
+    int32_t outputSize[2];
+    int32_t colorInput;
+};
+
+struct ScenePushConstants {
     int32_t imageSize[2];
+};
+
+struct ProfilePushConstants {
+    int32_t imageSize[2];
+};
+
+struct GlobalMotionPushConstants {
+    int32_t imageSize[2];
+    int32_t searchRadius;
+};
+
+struct TilePushConstants {
+    int32_t imageSize[2];
+    int32_t tileSize;
     int32_t blockSize;
-    float searchRadius;
 };
 
+struct MotionPushConstants {
+    int32_t imageSize[2];
+    int32_t hasPredictor;
+    int32_t hasTemporal;
+    // Blocks per tile side when dispatched over the changed tiles, else 0
+    int32_t tileBlocks;
+    int32_t tilesPerRow;
+};
+
+// Layer i of the output is interpolated at firstFactor + i * factorStep
 struct InterpolatePushConstants {
-    float interpolationFactor;
     int32_t imageSize[2];
+    float firstFactor;
+    float factorStep;
+    int32_t layerCount;
+    int32_t blockSize;
+    int32_t tileMode;
+    int32_t tileSize;
+    int32_t tilesPerRow;
+};
+
+// Luma histogram bins per frame for scene cut detection; mirrors
+// SCENE_BINS in shaders/tile_list.glsl
+inline constexpr uint32_t kSceneBins = 64;
+
+// Head of the tile list buffer; mirrors TileList in shaders/tile_list.glsl
+struct TileListHeader {
+    VkDispatchIndirectCommand motionDispatch;
+    VkDispatchIndirectCommand changedDispatch;
+    VkDispatchIndirectCommand unchangedDispatch;
+    uint32_t tileCount;
+    uint32_t sceneCut;
+    uint32_t globalMotion;
+    uint32_t lumaDifference;
+    uint32_t histograms[2 * kSceneBins];
+};
+
+// Motion between two frames, one texel of vectors per block. Texels hold
+// a sub-pixel vector and a match confidence, packed as described in
+// shaders/motion_field.glsl.
+struct MotionField {
+    Frame vectors;
+    uint32_t blockSize = 0;
+
+    // Finest level only: tiles of tileSize pixels that differ between the
+    // frames, those that do not and those that need a block search, so work
+    // can be launched over each
+    VkBuffer tileList = VK_NULL_HANDLE;
+    VkDeviceMemory tileListMemory = VK_NULL_HANDLE;
+    uint32_t tileSize = 0;
+    uint32_t tilesPerRow = 0;
+    uint32_t tileRows = 0;
+};
+
+// Luma levels of one frame, level 0 at full resolution and each further
+// level half the size of the previous one
+struct LumaPyramid {
+    std::vector<Frame> levels;
+    // Frame content the levels were built from
+    VkImage source = VK_NULL_HANDLE;
+    uint64_t serial = 0;
+};
+
+// Inputs and output of one level of a coarse-to-fine motion search.
+// Missing inputs refer to the output field, which is then never read.
+struct MotionLevel {
+    // 0 at full resolution
+    uint32_t index;
+    const Frame& previousLuma;
+    const Frame& currentLuma;
+    // Field of the next coarser level
+    const Frame& coarse;
+    // This level's field from the previous search
+    const Frame& temporal;
+    const MotionField& output;
+    // Finest field, holding the tile list and the scene cut flag
+    const MotionField& tiles;
+    bool hasPredictor;
+    bool hasTemporal;
+    // Only the blocks of the tiles listed for search are dispatched
+    bool culled;
+    VkSampler sampler;
+};
+
+// Engine that searches the levels of the motion pyramid. FrameManager
+// builds the luma pyramids and sorts the tiles, then records the levels
+// coarsest first with a barrier after each; an engine writes one level's
+// field from its inputs and must honour tile culling and scene cuts.
+class MotionEstimator {
+public:
+    // Motion an engine resolves at each level on top of its seed. Reach
+    // doubles with every coarser level, so a few levels cover the search
+    // radius; seeds from the previous search follow sustained motion
+    // beyond it.
+    static constexpr int32_t kLevelSearchRadius = 1;
+
+    virtual ~MotionEstimator() = default;
+
+    virtual const char* GetName() const = 0;
+    virtual bool CreateLayouts() = 0;
+    // Destroys layouts and resources; pipelines belong to the PipelineCache
+    virtual void Cleanup() = 0;
+
+    // Starts building the pipelines for params in the background
+    virtual void RequestPipelines(const KernelParams& params) = 0;
+    virtual bool ResolvePipelines() = 0;
+
+    // Scratch images per level, sized like the given fields
+    virtual bool CreateResources(const std::vector<MotionField>& fields) { return true; }
+    virtual void DestroyResources() {}
+
+    virtual void RecordLevel(VkCommandBuffer commandBuffer, const MotionLevel& level) = 0;
+
+protected:
+    static MotionPushConstants MakePushConstants(const MotionLevel& level);
+    // One workgroup per block of the level, launched indirectly over the
+    // searched tiles when the level is culled
+    static void DispatchBlocks(VkCommandBuffer commandBuffer, const MotionLevel& level);
 };
 
 class FrameManager {
 public:
+    static constexpr VkFormat kMotionFormat = VK_FORMAT_R32_UINT;
+
     static FrameManager& Get() {
         static FrameManager instance;
         return instance;
     }
 
-    bool Initialize(uint32_t width, uint32_t height);
+    bool Initialize(uint32_t width, uint32_t height, const KernelParams& params);
     void Cleanup();
 
+    // Switches to the pipeline variants for params, building them in the
+    // background if they are not cached yet
+    bool SetKernelParams(const KernelParams& params);
+    const KernelParams& GetKernelParams() const { return m_kernelParams; }
+    static bool ValidateKernelParams(const KernelParams& params);
+
     // Frame management
-    bool CreateFrame(Frame& frame, uint32_t width, uint32_t height);
+    bool CreateFrame(Frame& frame, uint32_t width, uint32_t height,
+                     VkFormat format = VK_FORMAT_R8G8B8A8_UNORM);
+    // Output of InterpolateFrames, one layer per factor
+    bool CreateFrameArray(Frame& frame, uint32_t width, uint32_t height, uint32_t layers,
+                          VkFormat format = VK_FORMAT_R8G8B8A8_UNORM);
     void DestroyFrame(Frame& frame);
     bool CopyFrameData(const Frame& source, Frame& destination);
     
-    // Frame interpolation
-    bool InterpolateFrames(const Frame& previous, const Frame& current, 
-                          Frame& output, float factor);
+    // Frame interpolation into every layer of an array frame, estimating
+    // motion once for all of them
+    bool InterpolateFrames(const Frame& previous, const Frame& current,
+                           Frame& output, float firstFactor, float factorStep);
+
+    // Coarse-to-fine search over luma pyramids of both frames, seeded with
+    // the vectors of the previous search. Only changed tiles that do not
+    // follow the translation of the whole frame are searched at full
+    // resolution. Skipped on the GPU when the frames
+    // show different scenes, leaving a zero field that interpolation
+    // answers by holding the nearest source frame. A frame's pyramid is built once
+    // and reused while its serial is unchanged, so a stream of frames
+    // builds one pyramid per frame. Returns the motion field, in GENERAL
+    // and readable by compute shaders until the search after next, or
+    // nullptr if its resources could not be created.
+    const MotionField* RecordMotionEstimation(VkCommandBuffer commandBuffer, const Frame& previous,
+                                        const Frame& current);
+    // Rebuilds the luma pyramid of frame even if it is cached, so the
+    // pyramid pass that motionWorkgroup sizes can be timed on its own
+    bool RecordPyramid(VkCommandBuffer commandBuffer, const Frame& frame);
+    // Records indirect dispatches over the changed and unchanged tiles of
+    // motion with the active kernel parameters. Images must already be in
+    // the layouts the shader expects.
+    void RecordInterpolation(VkCommandBuffer commandBuffer, const Frame& previous,
+                             const Frame& current, const MotionField& motion,
+                             Frame& output, float firstFactor, float factorStep);
+    bool ResolvePipelines();
+
+    // For reading motion fields, whose format need not support linear
+    // filtering
+    VkSampler GetPointSampler() const { return m_pointSampler; }
+
+    void TransitionImage(VkCommandBuffer commandBuffer, VkImage image,
+                         VkImageLayout oldLayout, VkImageLayout newLayout,
+                         VkAccessFlags srcAccess, VkAccessFlags dstAccess,
+                         VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage);
 
     // Buffer management
     bool CreateStagingBuffer(VkBuffer& buffer, VkDeviceMemory& memory, VkDeviceSize size);
@@ -61,30 +278,85 @@ private:
     bool CreateCommandPool();
 
     // Motion estimation resources
-    VkShaderModule m_motionShader = VK_NULL_HANDLE;
-    VkPipeline m_motionPipeline = VK_NULL_HANDLE;
-    VkPipelineLayout m_motionPipelineLayout = VK_NULL_HANDLE;
-    VkDescriptorSetLayout m_motionDescriptorSetLayout = VK_NULL_HANDLE;
-    VkDescriptorSet m_motionDescriptorSet = VK_NULL_HANDLE;
+    VkPipeline m_pyramidPipeline = VK_NULL_HANDLE;
+    DescriptorBinder m_pyramidBindings;
+    VkPipeline m_scenePipeline = VK_NULL_HANDLE;
+    DescriptorBinder m_sceneBindings;
+    VkPipeline m_profilePipeline = VK_NULL_HANDLE;
+    DescriptorBinder m_profileBindings;
+    VkPipeline m_globalPipeline = VK_NULL_HANDLE;
+    DescriptorBinder m_globalBindings;
+    VkPipeline m_tilePipeline = VK_NULL_HANDLE;
+    DescriptorBinder m_tileBindings;
+    // Indexed by MotionEngine; only the active one has pipelines
+    std::unique_ptr<MotionEstimator> m_motionEstimators[2];
+    // Pyramids of the last two frames seen, so the current frame's pyramid
+    // serves as the previous one for the next pair
+    LumaPyramid m_pyramids[2];
+    // Fields of every level for the last two searches; the older set is
+    // overwritten by the next search, which reads the newer one
+    std::vector<MotionField> m_motionFields[2];
+    // Column and row luma sums of the frames being searched
+    VkBuffer m_profileBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory m_profileMemory = VK_NULL_HANDLE;
+    uint32_t m_motionFieldSet = 0;
+    bool m_hasTemporalFields = false;
 
     // Frame interpolation resources
-    VkShaderModule m_interpolateShader = VK_NULL_HANDLE;
     VkPipeline m_interpolatePipeline = VK_NULL_HANDLE;
-    VkPipelineLayout m_interpolatePipelineLayout = VK_NULL_HANDLE;
-    VkDescriptorSetLayout m_interpolateDescriptorSetLayout = VK_NULL_HANDLE;
-    VkDescriptorSet m_interpolateDescriptorSet = VK_NULL_HANDLE;
+    DescriptorBinder m_interpolateBindings;
 
     // Shared resources
-    VkDescriptorPool m_descriptorPool = VK_NULL_HANDLE;
     VkSampler m_sampler = VK_NULL_HANDLE;
+    // For images that are only fetched, whose formats need not support
+    // linear filtering
+    VkSampler m_pointSampler = VK_NULL_HANDLE;
+    KernelParams m_kernelParams;
 
     // Pipeline creation
-    bool CreateMotionPipeline();
-    bool CreateInterpolatePipeline();
-    bool CreateDescriptorSets();
+    bool CreatePyramidLayout();
+    bool CreateSceneLayout();
+    bool CreateProfileLayout();
+    bool CreateGlobalLayout();
+    bool CreateTileLayout();
+    bool CreateInterpolateLayout();
+    bool CreateSampler();
+    bool CreateFrameImage(Frame& frame, uint32_t width, uint32_t height, uint32_t layers,
+                          VkFormat format);
+    bool CreateImageView(const Frame& frame, VkImageViewType type, uint32_t baseLayer,
+                         uint32_t layerCount, VkImageView& view);
+    ComputePipelineDesc PyramidPipelineDesc() const;
+    ComputePipelineDesc ScenePipelineDesc() const;
+    ComputePipelineDesc ProfilePipelineDesc() const;
+    ComputePipelineDesc GlobalPipelineDesc() const;
+    ComputePipelineDesc TilePipelineDesc() const;
+    ComputePipelineDesc InterpolatePipelineDesc() const;
 
-    // Shader loading
-    bool LoadShaderFile(const std::string& filename, std::vector<char>& buffer);
+    // Motion estimation helpers
+    MotionEstimator& GetMotionEstimator() const;
+    uint32_t PyramidLevelCount(uint32_t width, uint32_t height) const;
+    // Motion field for width x height frames at the active block size
+    bool CreateMotionField(MotionField& field, uint32_t width, uint32_t height);
+    bool CreateTileList(MotionField& field, uint32_t width, uint32_t height);
+    void DestroyMotionField(MotionField& field);
+    bool EnsureMotionResources(uint32_t width, uint32_t height);
+    void DestroyMotionResources();
+    // Cached pyramid of frame's current content, if any
+    const LumaPyramid* FindPyramid(const Frame& frame) const;
+    // Pyramid of frame, built unless cached; never overwrites keep
+    const LumaPyramid& PreparePyramid(VkCommandBuffer commandBuffer, const Frame& frame,
+                                      const LumaPyramid* keep);
+    void RecordPyramidLevel(VkCommandBuffer commandBuffer, const Frame& source,
+                            const Frame& level, bool colorInput);
+    // Gathers scene statistics from the coarsest luma levels and the global
+    // motion from the finest, then sorts the tiles of field. A scene cut
+    // lists every tile as unchanged; changed tiles that follow the global
+    // motion are not searched.
+    void RecordTileClassification(VkCommandBuffer commandBuffer, const Frame& previous,
+                                  const Frame& current, const LumaPyramid& previousPyramid,
+                                  const LumaPyramid& currentPyramid, const MotionField& field);
+    void GlobalBarrier(VkCommandBuffer commandBuffer, VkAccessFlags srcAccess, VkAccessFlags dstAccess,
+                       VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage);
 
     FrameManager(const FrameManager&) = delete;
     FrameManager& operator=(const FrameManager&) = delete;
@@ -0,0 +1,133 @@
+#include "frame_pacer.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <vector>
+#include "logger.hpp"
+
+namespace {
+
+constexpr int64_t kNsPerSecond = 1000000000;
+
+// Bounds for the calibrated spin margin
+constexpr int64_t kMinSpinNs = 50000;
+constexpr int64_t kMaxSpinNs = 2000000;
+
+void SleepUntil(int64_t deadline) {
+    timespec ts{
+        .tv_sec = static_cast<time_t>(deadline / kNsPerSecond),
+        .tv_nsec = static_cast<long>(deadline % kNsPerSecond)
+    };
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {
+    }
+}
+
+inline void CpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+} // namespace
+
+int64_t FramePacer::Now() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * kNsPerSecond + ts.tv_nsec;
+}
+
+void FramePacer::Start(uint32_t targetFps) {
+    m_targetFps = std::max(targetFps, 1u);
+    Calibrate();
+
+    m_origin = Now();
+    m_frame = 1;
+    ResetStats();
+
+    LOG_INFO("Frame pacer: ", m_targetFps, " FPS, period ",
+             static_cast<double>(kNsPerSecond) / m_targetFps / 1000.0, " us, spin margin ",
+             m_spinMarginNs / 1000, " us");
+}
+
+void FramePacer::Calibrate() {
+    // Sleep for short intervals and take a high percentile of the overshoot
+    // as the wake-up latency the spin has to cover
+    constexpr int kSamples = 32;
+    constexpr int64_t kSleepNs = 500000;
+
+    std::vector<int64_t> overshoot;
+    overshoot.reserve(kSamples);
+    for (int i = 0; i < kSamples; i++) {
+        int64_t target = Now() + kSleepNs;
+        SleepUntil(target);
+        overshoot.push_back(Now() - target);
+    }
+    std::sort(overshoot.begin(), overshoot.end());
+
+    int64_t latency = overshoot[kSamples * 9 / 10];
+    m_spinMarginNs = std::clamp(latency * 2, kMinSpinNs, kMaxSpinNs);
+}
+
+int64_t FramePacer::Deadline(uint64_t frame) const {
+    // Exact rational period: frame * 1e9 / fps never loses the remainder
+    return m_origin + static_cast<int64_t>(frame * kNsPerSecond / m_targetFps);
+}
+
+void FramePacer::Wait() {
+    int64_t deadline = Deadline(m_frame);
+    int64_t now = Now();
+
+    if (now >= deadline) {
+        // Late: skip to the first deadline still ahead so later frames stay
+        // on the original grid
+        m_stats.missed++;
+        m_stats.frames++;
+        uint64_t elapsed = static_cast<uint64_t>(now - m_origin);
+        m_frame = elapsed * m_targetFps / kNsPerSecond + 1;
+        return;
+    }
+
+    if (deadline - now > m_spinMarginNs) {
+        SleepUntil(deadline - m_spinMarginNs);
+    }
+    while ((now = Now()) < deadline) {
+        CpuRelax();
+    }
+
+    Record(now - deadline);
+    m_frame++;
+}
+
+void FramePacer::Record(int64_t errorNs) {
+    const auto& edges = PacingStats::kBucketEdgesUs;
+    int64_t errorUs = errorNs / 1000;
+    size_t bucket = std::upper_bound(edges.begin(), edges.end(), errorUs) - edges.begin();
+
+    m_stats.buckets[bucket]++;
+    m_stats.frames++;
+    m_stats.maxErrorNs = std::max(m_stats.maxErrorNs, errorNs);
+    m_stats.totalErrorNs += static_cast<double>(errorNs);
+}
+
+void FramePacer::LogStats() const {
+    if (m_stats.frames == 0) {
+        return;
+    }
+
+    uint64_t onTime = m_stats.frames - m_stats.missed;
+    double averageUs = onTime > 0 ? m_stats.totalErrorNs / onTime / 1000.0 : 0.0;
+    LOG_INFO("Pacing: ", m_stats.frames, " frames, ", m_stats.missed, " missed, error avg ",
+             averageUs, " us, max ", m_stats.maxErrorNs / 1000, " us");
+
+    std::stringstream histogram;
+    const auto& edges = PacingStats::kBucketEdgesUs;
+    for (size_t i = 0; i < m_stats.buckets.size(); i++) {
+        if (i < edges.size()) {
+            histogram << " <" << edges[i] << "us:" << m_stats.buckets[i];
+        } else {
+            histogram << " >=" << edges.back() << "us:" << m_stats.buckets[i];
+        }
+    }
+    LOG_INFO("Pacing error histogram:", histogram.str());
+}
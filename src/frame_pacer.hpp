@@ -0,0 +1,53 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <ctime>
+
+// Pacing error histogram. Errors are measured from each deadline to the
+// moment Wait() returned; frames that arrive after their deadline has
+// already passed are counted in missed instead.
+struct PacingStats {
+    // Upper bucket edges in microseconds; the last bucket is open-ended
+    static constexpr std::array<int64_t, 8> kBucketEdgesUs = {10, 25, 50, 100, 250, 500, 1000, 2000};
+
+    std::array<uint64_t, kBucketEdgesUs.size() + 1> buckets{};
+    uint64_t frames = 0;
+    uint64_t missed = 0;
+    int64_t maxErrorNs = 0;
+    double totalErrorNs = 0.0;
+};
+
+// Paces the main loop on CLOCK_MONOTONIC. Deadlines are derived from the
+// start time and the frame index, so rounding never accumulates into
+// drift. Each wait sleeps with an absolute clock_nanosleep until shortly
+// before the deadline and spins the rest, where the spin margin is the
+// measured wake-up latency of the scheduler.
+class FramePacer {
+public:
+    void Start(uint32_t targetFps);
+
+    // Blocks until the next frame deadline. Returns immediately if the
+    // deadline has passed; the schedule then skips ahead to the next
+    // whole period rather than trying to catch up.
+    void Wait();
+
+    const PacingStats& GetStats() const { return m_stats; }
+    void ResetStats() { m_stats = PacingStats{}; }
+    void LogStats() const;
+
+    int64_t GetSpinMarginNs() const { return m_spinMarginNs; }
+
+    static int64_t Now();
+
+private:
+    void Calibrate();
+    int64_t Deadline(uint64_t frame) const;
+    void Record(int64_t errorNs);
+
+    uint32_t m_targetFps = 60;
+    int64_t m_origin = 0;
+    uint64_t m_frame = 0;
+    int64_t m_spinMarginNs = 0;
+
+    PacingStats m_stats;
+};
@@ -0,0 +1,125 @@
+#include "frame_scheduler.hpp"
+#include <algorithm>
+
+namespace {
+
+// Share of the output period a generated frame may take on the GPU,
+// leaving room for capture and presentation
+constexpr double kBudgetFraction = 0.9;
+// Weight of the newest sample in the smoothed interval and cost
+constexpr double kSmoothing = 0.1;
+// While dropping, generate again this often to find out whether the GPU
+// has caught up
+constexpr uint32_t kProbeInterval = 60;
+
+double Smooth(double average, double sample) {
+    return average > 0.0 ? average + (sample - average) * kSmoothing : sample;
+}
+
+} // namespace
+
+bool ParseFrameGenerationMode(const std::string& name, FrameGenerationMode& mode) {
+    if (name == "interpolate") {
+        mode = FrameGenerationMode::Interpolate;
+    } else if (name == "extrapolate") {
+        mode = FrameGenerationMode::Extrapolate;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void FrameScheduler::Configure(uint32_t multiplier, uint32_t sourceFps,
+                               FrameGenerationMode mode, float extrapolationFraction) {
+    m_multiplier = std::max(multiplier, 1u);
+    m_mode = mode;
+    m_extrapolationFraction = extrapolationFraction;
+    m_phase = 0;
+    m_sourceFrames = 0;
+    m_motionValid = false;
+    m_generationCostMs = 0.0;
+    m_droppedSinceProbe = 0;
+    m_sourceIntervalMs = 1000.0 / std::max(sourceFps, 1u);
+    m_stats = SchedulerStats{};
+}
+
+void FrameScheduler::OnCaptured(int64_t timestamp) {
+    m_previousCapture = m_currentCapture;
+    m_currentCapture = timestamp;
+    if (m_sourceFrames++ > 0) {
+        m_sourceIntervalMs = Smooth(m_sourceIntervalMs, (m_currentCapture - m_previousCapture) / 1e6);
+    }
+    m_motionValid = false;
+}
+
+double FrameScheduler::OutputPeriodMs() const {
+    return m_sourceIntervalMs / m_multiplier;
+}
+
+void FrameScheduler::GetGeneratedFactors(float& first, float& step) const {
+    if (m_mode == FrameGenerationMode::Extrapolate) {
+        step = m_extrapolationFraction / m_multiplier;
+        first = 1.0f + step;
+    } else {
+        step = 1.0f / m_multiplier;
+        first = step;
+    }
+}
+
+ScheduledFrame FrameScheduler::Next() {
+    // Interpolated frames come before the current source frame in each
+    // source period, extrapolated ones after it
+    uint32_t phase = m_phase;
+    m_phase = (m_phase + 1) % m_multiplier;
+
+    bool generatedPhase;
+    uint32_t generatedIndex;
+    ScheduledFrame frame;
+    if (m_mode == FrameGenerationMode::Extrapolate) {
+        generatedPhase = phase > 0;
+        generatedIndex = phase - 1;
+    } else {
+        generatedPhase = phase + 1 < m_multiplier;
+        generatedIndex = phase;
+    }
+
+    if (generatedPhase && m_sourceFrames >= 2) {
+        float first, step;
+        GetGeneratedFactors(first, step);
+        frame.factor = first + generatedIndex * step;
+
+        bool overBudget = m_generationCostMs > OutputPeriodMs() * kBudgetFraction;
+        if (overBudget && ++m_droppedSinceProbe < kProbeInterval) {
+            frame.skip = true;
+            m_stats.dropped++;
+            return frame;
+        }
+        if (overBudget) {
+            // Probe: forget the old cost so the next measurement decides
+            m_generationCostMs = 0.0;
+        }
+        m_droppedSinceProbe = 0;
+
+        frame.generate = true;
+        frame.estimateMotion = !m_motionValid;
+        m_motionValid = true;
+        m_stats.generated++;
+    }
+
+    m_stats.presented++;
+    return frame;
+}
+
+void FrameScheduler::ReportGpuTime(bool generated, double ms) {
+    if (generated) {
+        m_generationCostMs = Smooth(m_generationCostMs, ms);
+    }
+}
+
+SchedulerStats FrameScheduler::TakeStats() {
+    SchedulerStats stats = m_stats;
+    stats.sourceIntervalMs = m_sourceIntervalMs;
+    stats.generationCostMs = m_generationCostMs;
+    m_stats = SchedulerStats{};
+    return stats;
+}
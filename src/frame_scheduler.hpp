@@ -0,0 +1,89 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+enum class FrameGenerationMode {
+    // Between the previous and current source frames; adds one source
+    // frame of latency
+    Interpolate,
+    // Beyond the current source frame along its motion; no added latency
+    Extrapolate
+};
+
+bool ParseFrameGenerationMode(const std::string& name, FrameGenerationMode& mode);
+
+// What one output frame shows
+struct ScheduledFrame {
+    // Generate at factor, where 0 is the previous and 1 the current source
+    // frame and factors above 1 are extrapolated; otherwise the current
+    // source frame is shown as is
+    bool generate = false;
+    float factor = 1.0f;
+    // First generated frame of a source pair: motion is estimated, later
+    // frames of the pair reuse the field
+    bool estimateMotion = false;
+    // Generation was dropped to stay within the GPU budget; nothing is
+    // presented for this output frame
+    bool skip = false;
+};
+
+struct SchedulerStats {
+    uint64_t presented = 0;
+    uint64_t generated = 0;
+    uint64_t dropped = 0;
+    double sourceIntervalMs = 0.0;
+    double generationCostMs = 0.0;
+};
+
+// Spreads a source stream over an output stream running multiplier times
+// faster. Each source period starts with a capture and shows multiplier - 1
+// generated frames plus the current source frame. When interpolating, the
+// generated frames sit between the previous and current source frames at
+// evenly spaced factors and come first, so the output trails capture by
+// one source frame. When extrapolating, the current source frame is shown
+// right away and followed by predictions spread over extrapolationFraction
+// of the next source period. Generated frames are dropped while their
+// measured GPU cost does not fit the output period.
+class FrameScheduler {
+public:
+    void Configure(uint32_t multiplier, uint32_t sourceFps,
+                   FrameGenerationMode mode = FrameGenerationMode::Interpolate,
+                   float extrapolationFraction = 1.0f);
+
+    uint32_t GetMultiplier() const { return m_multiplier; }
+    FrameGenerationMode GetMode() const { return m_mode; }
+    // Generated frame i of a source period sits at factor first + i * step
+    void GetGeneratedFactors(float& first, float& step) const;
+
+    // True when this output frame must start by capturing a source frame
+    bool NeedsCapture() const { return m_phase == 0; }
+    void OnCaptured(int64_t timestamp);
+
+    // Plans the current output frame and advances to the next one
+    ScheduledFrame Next();
+
+    // GPU time of a presented frame, measured once its work completed
+    void ReportGpuTime(bool generated, double ms);
+
+    SchedulerStats TakeStats();
+
+private:
+    double OutputPeriodMs() const;
+
+    uint32_t m_multiplier = 1;
+    uint32_t m_phase = 0;
+    FrameGenerationMode m_mode = FrameGenerationMode::Interpolate;
+    float m_extrapolationFraction = 1.0f;
+
+    int64_t m_previousCapture = 0;
+    int64_t m_currentCapture = 0;
+    uint64_t m_sourceFrames = 0;
+    double m_sourceIntervalMs = 0.0;
+    bool m_motionValid = false;
+
+    // Smoothed cost of a generated output frame, 0 until measured
+    double m_generationCostMs = 0.0;
+    uint32_t m_droppedSinceProbe = 0;
+
+    SchedulerStats m_stats;
+};
@@ -0,0 +1,282 @@
+#include "kernel_tuner.hpp"
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include "block_motion_estimator.hpp"
+#include "dis_motion_estimator.hpp"
+
+std::string KernelTuner::MakeKey(const ScalerConfig& config) const {
+    std::stringstream ss;
+    const uint8_t* uuid = VulkanContext::Get().GetDeviceUUID();
+    for (uint32_t i = 0; i < VK_UUID_SIZE; i++) {
+        ss << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(uuid[i]);
+    }
+    ss << std::dec << " " << config.inputWidth << "x" << config.inputHeight
+       << " " << config.outputWidth << "x" << config.outputHeight;
+    return ss.str();
+}
+
+std::vector<WorkgroupSize> KernelTuner::GetCandidates() const {
+    static const WorkgroupSize candidates[] = {
+        {8, 8}, {16, 8}, {8, 16}, {16, 16}, {32, 4}, {32, 8}, {64, 4}, {32, 16}, {32, 32}
+    };
+
+    const auto& limits = VulkanContext::Get().GetDeviceProperties().limits;
+    std::vector<WorkgroupSize> supported;
+    for (const auto& candidate : candidates) {
+        if (candidate.x <= limits.maxComputeWorkGroupSize[0] &&
+            candidate.y <= limits.maxComputeWorkGroupSize[1] &&
+            candidate.x * candidate.y <= limits.maxComputeWorkGroupInvocations) {
+            supported.push_back(candidate);
+        }
+    }
+    return supported;
+}
+
+bool KernelTuner::Load(const ScalerConfig& config, KernelParams& params) {
+    auto path = PipelineCache::GetCacheDirectory() / "tuning.txt";
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    // The separator keeps one resolution from matching another it is a
+    // prefix of
+    std::string key = MakeKey(config) + " ";
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.compare(0, key.size(), key) != 0) {
+            continue;
+        }
+
+        KernelParams loaded = params;
+        if (sscanf(line.c_str() + key.size(), " scale=%ux%u motion=%ux%u",
+                   &loaded.scaleWorkgroup.x, &loaded.scaleWorkgroup.y,
+                   &loaded.motionWorkgroup.x, &loaded.motionWorkgroup.y) != 4) {
+            LOG_WARN("Ignoring malformed tuning entry: ", line);
+            return false;
+        }
+
+        if (!FrameManager::ValidateKernelParams(loaded)) {
+            return false;
+        }
+
+        params = loaded;
+        LOG_INFO("Using tuned workgroup sizes: scale ", params.scaleWorkgroup.x, "x",
+                 params.scaleWorkgroup.y, ", motion ", params.motionWorkgroup.x, "x",
+                 params.motionWorkgroup.y);
+        return true;
+    }
+
+    return false;
+}
+
+bool KernelTuner::Save(const ScalerConfig& config, const KernelParams& params) {
+    auto directory = PipelineCache::GetCacheDirectory();
+    if (directory.empty()) {
+        LOG_WARN("No cache directory available, tuning results not saved");
+        return false;
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    auto path = directory / "tuning.txt";
+
+    // Keep entries for other devices and resolutions
+    std::string key = MakeKey(config) + " ";
+    std::vector<std::string> lines;
+    {
+        std::ifstream file(path);
+        std::string line;
+        while (std::getline(file, line)) {
+            if (!line.empty() && line.compare(0, key.size(), key) != 0) {
+                lines.push_back(line);
+            }
+        }
+    }
+
+    std::stringstream entry;
+    entry << key << "scale=" << params.scaleWorkgroup.x << "x" << params.scaleWorkgroup.y
+          << " motion=" << params.motionWorkgroup.x << "x" << params.motionWorkgroup.y;
+    lines.push_back(entry.str());
+
+    std::ofstream file(path, std::ios::trunc);
+    if (!file.is_open()) {
+        LOG_WARN("Failed to write ", path.string());
+        return false;
+    }
+    for (const auto& line : lines) {
+        file << line << "\n";
+    }
+
+    LOG_INFO("Saved tuning results to ", path.string());
+    return true;
+}
+
+double KernelTuner::TimeDispatches(const std::function<void(VkCommandBuffer)>& record) {
+    auto& vulkan = VulkanContext::Get();
+    auto& frameManager = FrameManager::Get();
+
+    VkCommandBuffer commandBuffer = frameManager.BeginSingleTimeCommands();
+    vkCmdResetQueryPool(commandBuffer, m_queryPool, 0, 2);
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_queryPool, 0);
+
+    for (uint32_t i = 0; i < kIterations; i++) {
+        record(commandBuffer);
+
+        // Serialize iterations like consecutive frames would be
+        VkMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        vkCmdPipelineBarrier(commandBuffer,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+            0, 1, &barrier, 0, nullptr, 0, nullptr);
+    }
+
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_queryPool, 1);
+    frameManager.EndSingleTimeCommands(commandBuffer);
+
+    uint64_t timestamps[2] = {};
+    if (vkGetQueryPoolResults(vulkan.GetDevice(), m_queryPool, 0, 2, sizeof(timestamps),
+                              timestamps, sizeof(uint64_t),
+                              VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT) != VK_SUCCESS) {
+        return -1.0;
+    }
+
+    return vulkan.TimestampIntervalMs(timestamps[0], timestamps[1]) / kIterations;
+}
+
+bool KernelTuner::Run(const ScalerConfig& config, KernelParams& tuned) {
+    auto& vulkan = VulkanContext::Get();
+    auto& frameManager = FrameManager::Get();
+
+    if (!vulkan.GetDeviceProperties().limits.timestampComputeAndGraphics ||
+        vulkan.GetTimestampValidBits() == 0) {
+        LOG_ERROR("Device does not support timestamp queries");
+        return false;
+    }
+
+    VkQueryPoolCreateInfo queryInfo{};
+    queryInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    queryInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    queryInfo.queryCount = 2;
+
+    if (vkCreateQueryPool(vulkan.GetDevice(), &queryInfo, nullptr, &m_queryPool) != VK_SUCCESS) {
+        LOG_ERROR("Failed to create timestamp query pool");
+        return false;
+    }
+
+    Frame previous, current, output;
+    bool success = frameManager.CreateFrame(previous, config.inputWidth, config.inputHeight,
+                                            WindowCapture::kFrameFormat) &&
+                   frameManager.CreateFrame(current, config.inputWidth, config.inputHeight,
+                                            WindowCapture::kFrameFormat) &&
+                   frameManager.CreateFrame(output, config.outputWidth, config.outputHeight);
+
+    // Time on real window content so data-dependent costs are representative
+    if (success) {
+        success = WindowCapture::Get().CaptureFrame(previous) &&
+                  WindowCapture::Get().CaptureFrame(current);
+    }
+
+    if (success) {
+        VkCommandBuffer commandBuffer = frameManager.BeginSingleTimeCommands();
+        frameManager.TransitionImage(commandBuffer, output.image,
+            VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+            0, VK_ACCESS_SHADER_WRITE_BIT,
+            VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+        frameManager.EndSingleTimeCommands(commandBuffer);
+    }
+
+    KernelParams params = frameManager.GetKernelParams();
+    KernelParams best = params;
+    double bestScale = std::numeric_limits<double>::max();
+    double bestPyramid = std::numeric_limits<double>::max();
+
+    for (const auto& candidate : success ? GetCandidates() : std::vector<WorkgroupSize>{}) {
+        params.scaleWorkgroup = candidate;
+        params.motionWorkgroup = candidate;
+        if (!frameManager.SetKernelParams(params) || !frameManager.ResolvePipelines()) {
+            continue;
+        }
+
+        auto recordScale = [&](VkCommandBuffer cmd) {
+            Scaler::Get().RecordScale(cmd, current, output);
+        };
+        // The block search runs one fixed-size workgroup per block, so
+        // motionWorkgroup only sizes the luma pyramid pass. That pass is
+        // timed on its own; the pyramid cache would otherwise skip it.
+        auto recordPyramid = [&](VkCommandBuffer cmd) {
+            frameManager.RecordPyramid(cmd, current);
+        };
+
+        // The first run absorbs one-off costs such as shader upload
+        TimeDispatches(recordScale);
+        double scaleMs = TimeDispatches(recordScale);
+        TimeDispatches(recordPyramid);
+        double pyramidMs = TimeDispatches(recordPyramid);
+
+        LOG_INFO("Tuning ", candidate.x, "x", candidate.y, ": scale ", scaleMs,
+                 " ms, luma pyramid ", pyramidMs, " ms");
+
+        if (scaleMs >= 0.0 && scaleMs < bestScale) {
+            bestScale = scaleMs;
+            best.scaleWorkgroup = candidate;
+        }
+        if (pyramidMs >= 0.0 && pyramidMs < bestPyramid) {
+            bestPyramid = pyramidMs;
+            best.motionWorkgroup = candidate;
+        }
+    }
+
+    // Compare the motion engines with the chosen workgroups; the configured
+    // engine stays in use, the timings are for picking one by hand
+    if (bestPyramid != std::numeric_limits<double>::max()) {
+        for (MotionEngine engine : {MotionEngine::Block, MotionEngine::Dis}) {
+            params = best;
+            params.motionEngine = engine;
+            bool fits = engine == MotionEngine::Dis
+                ? DisMotionEstimator::FitsDevice(params.motionBlockSize)
+                : BlockMotionEstimator::FitsDevice(params.motionBlockSize, params.motionSearchRadius);
+            if (!fits) {
+                LOG_INFO("Motion engine ", GetMotionEngineName(engine),
+                         ": skipped, block size exceeds the shared memory limit");
+                continue;
+            }
+            if (!frameManager.SetKernelParams(params) || !frameManager.ResolvePipelines()) {
+                continue;
+            }
+
+            auto recordMotion = [&](VkCommandBuffer cmd) {
+                frameManager.RecordMotionEstimation(cmd, previous, current);
+            };
+            TimeDispatches(recordMotion);
+            LOG_INFO("Motion engine ", GetMotionEngineName(engine), ": ",
+                     TimeDispatches(recordMotion), " ms");
+        }
+    }
+
+    frameManager.DestroyFrame(previous);
+    frameManager.DestroyFrame(current);
+    frameManager.DestroyFrame(output);
+    vkDestroyQueryPool(vulkan.GetDevice(), m_queryPool, nullptr);
+    m_queryPool = VK_NULL_HANDLE;
+
+    if (bestScale == std::numeric_limits<double>::max() ||
+        bestPyramid == std::numeric_limits<double>::max()) {
+        LOG_ERROR("Kernel tuning failed");
+        return false;
+    }
+
+    LOG_INFO("Best workgroup sizes: scale ", best.scaleWorkgroup.x, "x", best.scaleWorkgroup.y,
+             " (", bestScale, " ms), motion (luma pyramid) ", best.motionWorkgroup.x, "x",
+             best.motionWorkgroup.y, " (", bestPyramid, " ms)");
+
+    tuned = best;
+    frameManager.SetKernelParams(best);
+    Save(config, best);
+    return true;
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <functional>
+#include <string>
+#include <vector>
+#include "scaler.hpp"
+
+// Picks the fastest workgroup size for the scale and motion kernels by timing
+// each candidate with GPU timestamps at the configured resolutions. Results
+// are stored per device UUID and resolution under the cache directory and
+// picked up automatically on later starts.
+class KernelTuner {
+public:
+    static KernelTuner& Get() {
+        static KernelTuner instance;
+        return instance;
+    }
+
+    // Requires FrameManager and Scaler to be initialized
+    bool Run(const ScalerConfig& config, KernelParams& tuned);
+
+    // Applies stored results for this device and resolution, if any
+    bool Load(const ScalerConfig& config, KernelParams& params);
+
+private:
+    KernelTuner() = default;
+
+    static constexpr uint32_t kIterations = 5;
+
+    bool Save(const ScalerConfig& config, const KernelParams& params);
+    std::string MakeKey(const ScalerConfig& config) const;
+    std::vector<WorkgroupSize> GetCandidates() const;
+
+    // Returns the average GPU time of one recorded iteration in
+    // milliseconds, or a negative value on failure
+    double TimeDispatches(const std::function<void(VkCommandBuffer)>& record);
+
+    VkQueryPool m_queryPool = VK_NULL_HANDLE;
+};
@@ -1,8 +1,11 @@
 #include <cstdlib>
+#include <cstdio>
 #include <cstring>
 #include <thread>
 #include <chrono>
 #include "scaler.hpp"
+#include "kernel_tuner.hpp"
+#include "frame_pacer.hpp"
 #include "logger.hpp"
 
 void PrintUsage() {
@@ -13,16 +16,27 @@ void PrintUsage() {
               << "  --input-height HEIGHT    Input height (default: auto-detect)\n"
               << "  --output-width WIDTH     Output width\n"
               << "  --output-height HEIGHT   Output height\n"
-              << "  --target-fps FPS         Target FPS (default: 60)\n"
+              << "  --target-fps FPS         Capture rate; output runs at FPS times the multiplier (default: 60)\n"
               << "  --no-interpolation       Disable frame interpolation\n"
-              << "  --interpolation-factor F Interpolation blend factor (0.0-1.0, default: 0.5)\n";
+              << "  --fg-multiplier N        Output frames per captured frame, 1-8 (default: 2)\n"
+              << "  --fg-mode MODE           interpolate or extrapolate (default: interpolate)\n"
+              << "  --extrapolation-fraction F Share of the next source frame interval to predict, 0-1 (default: 1)\n"
+              << "  --workgroup-size WxH     Compute workgroup size for all kernels (default: 16x16)\n"
+              << "  --lanczos-radius N       Lanczos filter radius (default: 3)\n"
+              << "  --motion-block-size N    Motion estimation block size (default: 8)\n"
+              << "  --motion-search-radius N Largest motion found, in pixels (default: 16)\n"
+              << "  --motion-engine ENGINE   block or dis (default: block)\n"
+              << "  --tune                   Benchmark workgroup sizes on this GPU, store the best and exit\n"
+              << "  --present-mode MODE      fifo, fifo-relaxed, mailbox or immediate (default: fifo)\n"
+              << "  --low-latency            Keep at most one frame queued for display\n";
 }
 
 int main(int argc, char* argv[]) {
     uint32_t windowId = 0;
     ScalerConfig config;
+    bool tune = false;
+    bool workgroupSpecified = false;
     config.enableInterpolation = true;
-    config.interpolationFactor = 0.5f;
     config.targetFps = 60;
 
     for (int i = 1; i < argc; i++) {
@@ -39,10 +53,59 @@ int main(int argc, char* argv[]) {
             config.outputHeight = std::atoi(argv[++i]);
         } else if (strcmp(argv[i], "--target-fps") == 0 && i + 1 < argc) {
             config.targetFps = std::atoi(argv[++i]);
+            if (config.targetFps == 0) {
+                LOG_ERROR("Invalid target FPS");
+                return 1;
+            }
         } else if (strcmp(argv[i], "--no-interpolation") == 0) {
             config.enableInterpolation = false;
-        } else if (strcmp(argv[i], "--interpolation-factor") == 0 && i + 1 < argc) {
-            config.interpolationFactor = std::atof(argv[++i]);
+        } else if (strcmp(argv[i], "--fg-multiplier") == 0 && i + 1 < argc) {
+            config.fgMultiplier = std::atoi(argv[++i]);
+            if (config.fgMultiplier < 1 || config.fgMultiplier > 8) {
+                LOG_ERROR("Invalid frame generation multiplier, expected 1-8");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--fg-mode") == 0 && i + 1 < argc) {
+            if (!ParseFrameGenerationMode(argv[++i], config.fgMode)) {
+                LOG_ERROR("Invalid frame generation mode, expected interpolate or extrapolate");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--extrapolation-fraction") == 0 && i + 1 < argc) {
+            config.extrapolationFraction = std::atof(argv[++i]);
+            if (config.extrapolationFraction <= 0.0f || config.extrapolationFraction > 1.0f) {
+                LOG_ERROR("Invalid extrapolation fraction, expected a value in (0, 1]");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--workgroup-size") == 0 && i + 1 < argc) {
+            WorkgroupSize workgroup;
+            if (sscanf(argv[++i], "%ux%u", &workgroup.x, &workgroup.y) != 2) {
+                LOG_ERROR("Invalid workgroup size, expected WxH");
+                return 1;
+            }
+            config.kernel.scaleWorkgroup = workgroup;
+            config.kernel.motionWorkgroup = workgroup;
+            config.kernel.interpolateWorkgroup = workgroup;
+            workgroupSpecified = true;
+        } else if (strcmp(argv[i], "--lanczos-radius") == 0 && i + 1 < argc) {
+            config.kernel.lanczosRadius = std::atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--motion-block-size") == 0 && i + 1 < argc) {
+            config.kernel.motionBlockSize = std::atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--motion-search-radius") == 0 && i + 1 < argc) {
+            config.kernel.motionSearchRadius = std::atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--motion-engine") == 0 && i + 1 < argc) {
+            if (!ParseMotionEngine(argv[++i], config.kernel.motionEngine)) {
+                LOG_ERROR("Invalid motion engine, expected block or dis");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--tune") == 0) {
+            tune = true;
+        } else if (strcmp(argv[i], "--present-mode") == 0 && i + 1 < argc) {
+            if (!ParsePresentMode(argv[++i], config.presentMode)) {
+                LOG_ERROR("Invalid present mode, expected fifo, fifo-relaxed, mailbox or immediate");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--low-latency") == 0) {
+            config.lowLatency = true;
         } else if (windowId == 0) {
             char* endPtr;
             windowId = std::strtoul(argv[i], &endPtr, 0);
@@ -89,56 +152,93 @@ int main(int argc, char* argv[]) {
         }
     }
 
+    auto startupBegin = std::chrono::steady_clock::now();
+
     if (!VulkanContext::Get().Initialize()) {
         LOG_ERROR("Failed to initialize Vulkan");
         WindowCapture::Get().Cleanup();
         return 1;
     }
 
-    if (!FrameManager::Get().Initialize(config.outputWidth, config.outputHeight)) {
-        LOG_ERROR("Failed to initialize frame manager");
+    if (!PipelineCache::Get().Initialize()) {
+        LOG_ERROR("Failed to initialize pipeline cache");
+        WindowCapture::Get().Cleanup();
         VulkanContext::Get().Cleanup();
+        return 1;
+    }
+
+    // Explicit workgroup sizes on the command line win over tuned ones
+    if (!tune && !workgroupSpecified) {
+        KernelTuner::Get().Load(config, config.kernel);
+    }
+
+    if (!FrameManager::Get().Initialize(config.outputWidth, config.outputHeight, config.kernel)) {
+        LOG_ERROR("Failed to initialize frame manager");
+        PipelineCache::Get().Cleanup();
         WindowCapture::Get().Cleanup();
+        VulkanContext::Get().Cleanup();
         return 1;
     }
 
     if (!Scaler::Get().Initialize(config)) {
         LOG_ERROR("Failed to initialize scaler");
         FrameManager::Get().Cleanup();
-        VulkanContext::Get().Cleanup();
+        PipelineCache::Get().Cleanup();
         WindowCapture::Get().Cleanup();
+        VulkanContext::Get().Cleanup();
         return 1;
     }
 
+    auto startupMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - startupBegin).count();
+    LOG_INFO("Startup took ", startupMs, " ms, of which ",
+             PipelineCache::Get().GetCreationTimeMs(), " ms creating ",
+             PipelineCache::Get().GetCreatedCount(), " pipelines (pipeline cache ",
+             PipelineCache::Get().WasLoaded() ? "warm" : "cold", ")");
+
+    if (tune) {
+        bool tuned = KernelTuner::Get().Run(config, config.kernel);
+        Scaler::Get().Cleanup();
+        FrameManager::Get().Cleanup();
+        PipelineCache::Get().Cleanup();
+        WindowCapture::Get().Cleanup();
+        VulkanContext::Get().Cleanup();
+        return tuned ? 0 : 1;
+    }
+
     LOG_INFO("Starting main loop");
-    const uint32_t frameDelay = 1000 / config.targetFps;
-    uint32_t frameStart;
-    int frameTime;
+    FramePacer pacer;
+    uint32_t multiplier = config.enableInterpolation ? config.fgMultiplier : 1;
+    pacer.Start(config.targetFps * multiplier);
+    // Log the pacing histogram roughly every ten seconds
+    const uint64_t statsInterval = static_cast<uint64_t>(config.targetFps) * multiplier * 10;
 
     try {
         while (true) {
-            frameStart = SDL_GetTicks();
-            
             if (!Scaler::Get().ProcessFrame()) {
                 LOG_INFO("ProcessFrame returned false, cleaning up...");
                 break;  // This will exit the loop cleanly
             }
-            
-            frameTime = SDL_GetTicks() - frameStart;
-            if (frameDelay > frameTime) {
-                SDL_Delay(frameDelay - frameTime);
+
+            pacer.Wait();
+
+            if (pacer.GetStats().frames >= statsInterval) {
+                pacer.LogStats();
+                pacer.ResetStats();
             }
         }
     } catch (const std::exception& e) {
         LOG_ERROR("Exception caught: ", e.what());
     }
+    pacer.LogStats();
 
     // Make sure cleanup happens in correct order
     LOG_INFO("Starting cleanup...");
     Scaler::Get().Cleanup();
     FrameManager::Get().Cleanup();
-    VulkanContext::Get().Cleanup();
+    PipelineCache::Get().Cleanup();
     WindowCapture::Get().Cleanup();
+    VulkanContext::Get().Cleanup();
 
     return 0;
 }
@@ -0,0 +1,314 @@
+#include "pipeline_cache.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+std::filesystem::path PipelineCache::GetCacheDirectory() {
+    const char* xdgCache = getenv("XDG_CACHE_HOME");
+    if (xdgCache && xdgCache[0] != '\0') {
+        return std::filesystem::path(xdgCache) / "lossless-scaling";
+    }
+
+    const char* home = getenv("HOME");
+    if (home && home[0] != '\0') {
+        return std::filesystem::path(home) / ".cache" / "lossless-scaling";
+    }
+
+    return {};
+}
+
+std::filesystem::path PipelineCache::GetCachePath() const {
+    auto directory = GetCacheDirectory();
+    if (directory.empty()) {
+        return {};
+    }
+    return directory / "pipeline_cache.bin";
+}
+
+PipelineCache::FileHeader PipelineCache::MakeHeader() const {
+    const auto& vulkan = VulkanContext::Get();
+    const auto& properties = vulkan.GetDeviceProperties();
+
+    FileHeader header{};
+    header.magic = kMagic;
+    header.version = kVersion;
+    header.vendorID = properties.vendorID;
+    header.deviceID = properties.deviceID;
+    header.driverVersion = properties.driverVersion;
+    memcpy(header.deviceUUID, vulkan.GetDeviceUUID(), VK_UUID_SIZE);
+    memcpy(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE);
+    return header;
+}
+
+bool PipelineCache::Initialize() {
+    std::vector<char> data;
+    m_loaded = LoadFromDisk(data);
+
+    VkPipelineCacheCreateInfo cacheInfo{};
+    cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    cacheInfo.initialDataSize = data.size();
+    cacheInfo.pInitialData = data.empty() ? nullptr : data.data();
+
+    VkResult result = vkCreatePipelineCache(VulkanContext::Get().GetDevice(), &cacheInfo,
+                                            nullptr, &m_cache);
+    if (result != VK_SUCCESS && m_loaded) {
+        LOG_WARN("Driver rejected pipeline cache data, starting empty");
+        m_loaded = false;
+        cacheInfo.initialDataSize = 0;
+        cacheInfo.pInitialData = nullptr;
+        result = vkCreatePipelineCache(VulkanContext::Get().GetDevice(), &cacheInfo,
+                                       nullptr, &m_cache);
+    }
+
+    if (result != VK_SUCCESS) {
+        LOG_ERROR("Failed to create pipeline cache");
+        return false;
+    }
+
+    m_creationTime = {};
+    m_createdCount = 0;
+    LOG_INFO("Pipeline cache ", m_loaded ? "loaded" : "cold", " (", data.size(), " bytes)");
+    return true;
+}
+
+bool PipelineCache::LoadFromDisk(std::vector<char>& data) {
+    auto path = GetCachePath();
+    if (path.empty()) {
+        return false;
+    }
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    FileHeader header{};
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        LOG_WARN("Pipeline cache file truncated, ignoring");
+        return false;
+    }
+
+    FileHeader expected = MakeHeader();
+    if (header.magic != expected.magic || header.version != expected.version ||
+        header.vendorID != expected.vendorID || header.deviceID != expected.deviceID ||
+        header.driverVersion != expected.driverVersion ||
+        memcmp(header.deviceUUID, expected.deviceUUID, VK_UUID_SIZE) != 0 ||
+        memcmp(header.pipelineCacheUUID, expected.pipelineCacheUUID, VK_UUID_SIZE) != 0) {
+        LOG_INFO("Pipeline cache was written for a different device or driver, ignoring");
+        return false;
+    }
+
+    // The size comes from disk; a corrupt header must not decide how much
+    // is allocated
+    std::error_code error;
+    uintmax_t fileSize = std::filesystem::file_size(path, error);
+    if (error || header.dataSize > fileSize - sizeof(header)) {
+        LOG_WARN("Pipeline cache file truncated, ignoring");
+        return false;
+    }
+
+    data.resize(header.dataSize);
+    if (!file.read(data.data(), header.dataSize)) {
+        LOG_WARN("Pipeline cache file truncated, ignoring");
+        data.clear();
+        return false;
+    }
+
+    return true;
+}
+
+bool PipelineCache::SaveToDisk() {
+    auto path = GetCachePath();
+    if (path.empty()) {
+        LOG_WARN("No cache directory available, pipeline cache not saved");
+        return false;
+    }
+
+    auto device = VulkanContext::Get().GetDevice();
+    size_t size = 0;
+    if (vkGetPipelineCacheData(device, m_cache, &size, nullptr) != VK_SUCCESS) {
+        return false;
+    }
+
+    std::vector<char> data(size);
+    if (vkGetPipelineCacheData(device, m_cache, &size, data.data()) != VK_SUCCESS) {
+        return false;
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(path.parent_path(), error);
+    if (error) {
+        LOG_WARN("Failed to create cache directory: ", error.message());
+        return false;
+    }
+
+    // Write to a temporary file first so a crash never leaves a torn cache
+    auto tempPath = path;
+    tempPath += ".tmp";
+
+    FileHeader header = MakeHeader();
+    header.dataSize = size;
+
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            LOG_WARN("Failed to open ", tempPath.string(), " for writing");
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(data.data(), size);
+        if (!file) {
+            LOG_WARN("Failed to write pipeline cache");
+            return false;
+        }
+    }
+
+    std::filesystem::rename(tempPath, path, error);
+    if (error) {
+        LOG_WARN("Failed to store pipeline cache: ", error.message());
+        return false;
+    }
+
+    LOG_INFO("Saved pipeline cache (", size, " bytes) to ", path.string());
+    return true;
+}
+
+VkPipeline PipelineCache::BuildComputePipeline(const ComputePipelineDesc& desc) {
+    auto device = VulkanContext::Get().GetDevice();
+    auto start = std::chrono::steady_clock::now();
+
+    VkShaderModuleCreateInfo moduleInfo{};
+    moduleInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    moduleInfo.codeSize = desc.codeSize;
+    moduleInfo.pCode = desc.code;
+
+    VkShaderModule module = VK_NULL_HANDLE;
+    if (vkCreateShaderModule(device, &moduleInfo, nullptr, &module) != VK_SUCCESS) {
+        LOG_ERROR("Failed to create ", desc.name, " shader module");
+        return VK_NULL_HANDLE;
+    }
+
+    std::vector<VkSpecializationMapEntry> entries(desc.specialization.size());
+    for (uint32_t i = 0; i < entries.size(); i++) {
+        entries[i].constantID = i;
+        entries[i].offset = i * sizeof(uint32_t);
+        entries[i].size = sizeof(uint32_t);
+    }
+
+    VkSpecializationInfo specializationInfo{};
+    specializationInfo.mapEntryCount = static_cast<uint32_t>(entries.size());
+    specializationInfo.pMapEntries = entries.data();
+    specializationInfo.dataSize = desc.specialization.size() * sizeof(uint32_t);
+    specializationInfo.pData = desc.specialization.data();
+
+    VkComputePipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineInfo.stage.module = module;
+    pipelineInfo.stage.pName = "main";
+    pipelineInfo.stage.pSpecializationInfo = entries.empty() ? nullptr : &specializationInfo;
+    pipelineInfo.layout = desc.layout;
+
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    VkResult result = vkCreateComputePipelines(device, m_cache, 1, &pipelineInfo,
+                                               nullptr, &pipeline);
+
+    // The module is only needed while the pipeline is being compiled
+    vkDestroyShaderModule(device, module, nullptr);
+
+    {
+        std::lock_guard<std::mutex> lock(m_statsMutex);
+        m_creationTime += std::chrono::steady_clock::now() - start;
+        m_createdCount++;
+    }
+
+    if (result != VK_SUCCESS) {
+        LOG_ERROR("Failed to create ", desc.name, " compute pipeline");
+        return VK_NULL_HANDLE;
+    }
+
+    return pipeline;
+}
+
+std::shared_future<VkPipeline>& PipelineCache::FindOrLaunch(const ComputePipelineDesc& desc) {
+    VariantKey key{desc.code, desc.layout, desc.specialization};
+    auto it = m_variants.find(key);
+    if (it != m_variants.end()) {
+        return it->second;
+    }
+
+    if (m_pendingCount++ == 0) {
+        m_pendingSince = std::chrono::steady_clock::now();
+    }
+
+    auto future = std::async(std::launch::async, [this, desc]() {
+        return BuildComputePipeline(desc);
+    }).share();
+    return m_variants.emplace(std::move(key), std::move(future)).first->second;
+}
+
+VkPipeline PipelineCache::GetComputePipeline(const ComputePipelineDesc& desc) {
+    std::shared_future<VkPipeline> future;
+    {
+        std::lock_guard<std::mutex> lock(m_variantsMutex);
+        future = FindOrLaunch(desc);
+    }
+    return future.get();
+}
+
+void PipelineCache::RequestComputePipeline(const ComputePipelineDesc& desc) {
+    std::lock_guard<std::mutex> lock(m_variantsMutex);
+    FindOrLaunch(desc);
+}
+
+bool PipelineCache::WaitForPipelines() {
+    std::lock_guard<std::mutex> lock(m_variantsMutex);
+
+    bool success = true;
+    for (auto& [key, future] : m_variants) {
+        success = future.get() != VK_NULL_HANDLE && success;
+    }
+
+    if (m_pendingCount > 0) {
+        auto wallMs = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - m_pendingSince).count();
+        LOG_INFO("Built ", m_pendingCount, " pipelines in parallel in ", wallMs, " ms");
+        m_pendingCount = 0;
+    }
+
+    return success;
+}
+
+void PipelineCache::DestroyVariants() {
+    auto device = VulkanContext::Get().GetDevice();
+
+    std::lock_guard<std::mutex> lock(m_variantsMutex);
+    for (auto& [key, future] : m_variants) {
+        VkPipeline pipeline = future.get();
+        if (pipeline != VK_NULL_HANDLE) {
+            vkDestroyPipeline(device, pipeline, nullptr);
+        }
+    }
+    m_variants.clear();
+    m_pendingCount = 0;
+}
+
+double PipelineCache::GetCreationTimeMs() const {
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    return std::chrono::duration<double, std::milli>(m_creationTime).count();
+}
+
+void PipelineCache::Cleanup() {
+    if (m_cache == VK_NULL_HANDLE) {
+        return;
+    }
+
+    WaitForPipelines();
+    DestroyVariants();
+
+    SaveToDisk();
+    vkDestroyPipelineCache(VulkanContext::Get().GetDevice(), m_cache, nullptr);
+    m_cache = VK_NULL_HANDLE;
+    m_loaded = false;
+}
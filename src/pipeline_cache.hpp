@@ -0,0 +1,96 @@
+#pragma once
+#include <chrono>
+#include <filesystem>
+#include <future>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <vector>
+#include "vulkan_context.hpp"
+
+struct ComputePipelineDesc {
+    const char* name = "";
+    const uint32_t* code = nullptr;
+    size_t codeSize = 0;  // in bytes
+    VkPipelineLayout layout = VK_NULL_HANDLE;
+    // Value of specialization constant i is specialization[i]
+    std::vector<uint32_t> specialization;
+};
+
+// Wraps a VkPipelineCache that is persisted across runs under
+// $XDG_CACHE_HOME/lossless-scaling. The blob on disk is prefixed with our own
+// header so a cache written by another GPU or driver build is discarded
+// instead of being handed to the driver.
+class PipelineCache {
+public:
+    static PipelineCache& Get() {
+        static PipelineCache instance;
+        return instance;
+    }
+
+    bool Initialize();
+    void Cleanup();
+
+    VkPipelineCache GetHandle() const { return m_cache; }
+    bool WasLoaded() const { return m_loaded; }
+
+    // Pipelines are cached per (shader, layout, specialization values) and
+    // owned by the cache. GetComputePipeline returns the cached variant,
+    // building it on the calling thread if nobody requested it yet, and
+    // returns VK_NULL_HANDLE if it failed to build.
+    VkPipeline GetComputePipeline(const ComputePipelineDesc& desc);
+
+    // Starts building a variant on a worker thread
+    void RequestComputePipeline(const ComputePipelineDesc& desc);
+    bool WaitForPipelines();
+
+    // Time spent inside vkCreateComputePipelines since Initialize, summed
+    // over all worker threads
+    double GetCreationTimeMs() const;
+    uint32_t GetCreatedCount() const { return m_createdCount; }
+
+    static std::filesystem::path GetCacheDirectory();
+
+private:
+    PipelineCache() = default;
+    ~PipelineCache() { Cleanup(); }
+
+    struct FileHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t vendorID;
+        uint32_t deviceID;
+        uint32_t driverVersion;
+        uint8_t deviceUUID[VK_UUID_SIZE];
+        uint8_t pipelineCacheUUID[VK_UUID_SIZE];
+        uint64_t dataSize;
+    };
+
+    static constexpr uint32_t kMagic = 0x4C535043; // "LSPC"
+    static constexpr uint32_t kVersion = 1;
+
+    using VariantKey = std::tuple<const uint32_t*, VkPipelineLayout, std::vector<uint32_t>>;
+
+    std::shared_future<VkPipeline>& FindOrLaunch(const ComputePipelineDesc& desc);
+    VkPipeline BuildComputePipeline(const ComputePipelineDesc& desc);
+    void DestroyVariants();
+
+    bool LoadFromDisk(std::vector<char>& data);
+    bool SaveToDisk();
+    FileHeader MakeHeader() const;
+    std::filesystem::path GetCachePath() const;
+
+    VkPipelineCache m_cache = VK_NULL_HANDLE;
+    bool m_loaded = false;
+    mutable std::mutex m_statsMutex;
+    std::chrono::steady_clock::duration m_creationTime{};
+    uint32_t m_createdCount = 0;
+
+    std::mutex m_variantsMutex;
+    std::map<VariantKey, std::shared_future<VkPipeline>> m_variants;
+    size_t m_pendingCount = 0;
+    std::chrono::steady_clock::time_point m_pendingSince;
+
+    PipelineCache(const PipelineCache&) = delete;
+    PipelineCache& operator=(const PipelineCache&) = delete;
+};
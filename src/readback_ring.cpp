@@ -0,0 +1,219 @@
+#include "readback_ring.hpp"
+
+bool ReadbackRing::Create(uint32_t width, uint32_t height, Consumer consumer, uint32_t depth) {
+    auto& vulkan = VulkanContext::Get();
+    auto device = vulkan.GetDevice();
+
+    m_width = width;
+    m_height = height;
+    m_slotSize = static_cast<VkDeviceSize>(width) * height * 4;
+    m_consumer = std::move(consumer);
+
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.queueFamilyIndex = vulkan.GetComputeQueueFamily();
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+
+    if (vkCreateCommandPool(device, &poolInfo, nullptr, &m_commandPool) != VK_SUCCESS) {
+        LOG_ERROR("Failed to create readback command pool");
+        return false;
+    }
+
+    // Cached memory makes CPU reads of the mapped data run at full speed;
+    // uncached coherent memory is the fallback
+    VkMemoryPropertyFlags properties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+    if (!vulkan.SupportsMemoryProperties(properties)) {
+        LOG_WARN("No host-cached memory, readback will use uncached memory");
+        properties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    }
+
+    m_slots.resize(depth);
+    for (auto& slot : m_slots) {
+        if (!vulkan.CreateBuffer(m_slotSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT, properties,
+                                 slot.buffer, slot.memory)) {
+            LOG_ERROR("Failed to create readback buffer");
+            Destroy();
+            return false;
+        }
+
+        if (vkMapMemory(device, slot.memory, 0, VK_WHOLE_SIZE, 0, &slot.mapped) != VK_SUCCESS) {
+            LOG_ERROR("Failed to map readback buffer");
+            Destroy();
+            return false;
+        }
+
+        VkCommandBufferAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.commandPool = m_commandPool;
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInfo.commandBufferCount = 1;
+
+        VkFenceCreateInfo fenceInfo{};
+        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+        if (vkAllocateCommandBuffers(device, &allocInfo, &slot.commandBuffer) != VK_SUCCESS ||
+            vkCreateFence(device, &fenceInfo, nullptr, &slot.fence) != VK_SUCCESS) {
+            LOG_ERROR("Failed to create readback command buffer");
+            Destroy();
+            return false;
+        }
+    }
+
+    LOG_INFO("Readback ring: ", depth, " x ", m_slotSize / 1024, " KiB");
+    return true;
+}
+
+bool ReadbackRing::Submit(const Frame& source, VkImageLayout layout,
+                          VkPipelineStageFlags srcStage, VkAccessFlags srcAccess) {
+    if (source.width > m_width || source.height > m_height) {
+        LOG_ERROR("Frame ", source.width, "x", source.height, " does not fit the readback ring");
+        return false;
+    }
+
+    // Ring full: the consumer has to catch up before the slot is reused
+    while (m_slots[m_next].pending) {
+        DeliverOldest(true);
+    }
+
+    Slot& slot = m_slots[m_next];
+    auto& frameManager = FrameManager::Get();
+
+    vkResetCommandBuffer(slot.commandBuffer, 0);
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(slot.commandBuffer, &beginInfo);
+
+    frameManager.TransitionImage(slot.commandBuffer, source.image,
+        layout, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+        srcAccess, VK_ACCESS_TRANSFER_READ_BIT,
+        srcStage, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+    VkBufferImageCopy region{};
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.layerCount = 1;
+    region.imageExtent = {source.width, source.height, 1};
+
+    vkCmdCopyImageToBuffer(slot.commandBuffer, source.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                           slot.buffer, 1, &region);
+
+    if (layout != VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL && layout != VK_IMAGE_LAYOUT_UNDEFINED) {
+        frameManager.TransitionImage(slot.commandBuffer, source.image,
+            VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, layout,
+            0, 0,
+            VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+    }
+
+    VkBufferMemoryBarrier hostBarrier{};
+    hostBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    hostBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    hostBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    hostBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    hostBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    hostBarrier.buffer = slot.buffer;
+    hostBarrier.size = VK_WHOLE_SIZE;
+
+    vkCmdPipelineBarrier(slot.commandBuffer,
+        VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+        0, 0, nullptr, 1, &hostBarrier, 0, nullptr);
+
+    if (vkEndCommandBuffer(slot.commandBuffer) != VK_SUCCESS) {
+        LOG_ERROR("Failed to record readback command buffer");
+        return false;
+    }
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &slot.commandBuffer;
+
+    if (VulkanContext::Get().Submit(submitInfo, slot.fence) != VK_SUCCESS) {
+        LOG_ERROR("Failed to submit readback");
+        return false;
+    }
+
+    slot.width = source.width;
+    slot.height = source.height;
+    slot.format = source.format;
+    slot.frameIndex = m_frameCounter++;
+    slot.pending = true;
+    m_next = (m_next + 1) % m_slots.size();
+    return true;
+}
+
+bool ReadbackRing::DeliverOldest(bool wait) {
+    Slot& slot = m_slots[m_oldest];
+    if (!slot.pending) {
+        return false;
+    }
+
+    auto device = VulkanContext::Get().GetDevice();
+    if (wait) {
+        vkWaitForFences(device, 1, &slot.fence, VK_TRUE, UINT64_MAX);
+    } else if (vkGetFenceStatus(device, slot.fence) != VK_SUCCESS) {
+        return false;
+    }
+
+    // No-op on coherent memory; required before reading cached memory
+    VkMappedMemoryRange range{};
+    range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+    range.memory = slot.memory;
+    range.size = VK_WHOLE_SIZE;
+    vkInvalidateMappedMemoryRanges(device, 1, &range);
+
+    if (m_consumer) {
+        ReadbackView view{
+            .data = static_cast<const uint8_t*>(slot.mapped),
+            .width = slot.width,
+            .height = slot.height,
+            .stride = slot.width * 4,
+            .format = slot.format,
+            .frameIndex = slot.frameIndex
+        };
+        m_consumer(view);
+    }
+
+    vkResetFences(device, 1, &slot.fence);
+    slot.pending = false;
+    m_oldest = (m_oldest + 1) % m_slots.size();
+    return true;
+}
+
+void ReadbackRing::Poll() {
+    while (DeliverOldest(false)) {
+    }
+}
+
+void ReadbackRing::Destroy() {
+    auto device = VulkanContext::Get().GetDevice();
+    if (!device) {
+        return;
+    }
+
+    for (auto& slot : m_slots) {
+        if (slot.pending) {
+            vkWaitForFences(device, 1, &slot.fence, VK_TRUE, UINT64_MAX);
+        }
+        if (slot.fence != VK_NULL_HANDLE) {
+            VulkanContext::Get().ReleaseFence(slot.fence);
+            vkDestroyFence(device, slot.fence, nullptr);
+        }
+        if (slot.mapped) {
+            vkUnmapMemory(device, slot.memory);
+        }
+        if (slot.buffer != VK_NULL_HANDLE) {
+            VulkanContext::Get().DestroyBuffer(slot.buffer, slot.memory);
+        }
+    }
+    m_slots.clear();
+
+    // Frees the slot command buffers with it
+    if (m_commandPool != VK_NULL_HANDLE) {
+        vkDestroyCommandPool(device, m_commandPool, nullptr);
+        m_commandPool = VK_NULL_HANDLE;
+    }
+
+    m_next = 0;
+    m_oldest = 0;
+}
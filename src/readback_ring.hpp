@@ -0,0 +1,69 @@
+#pragma once
+#include <functional>
+#include <vector>
+#include "frame_manager.hpp"
+
+// A finished readback. data points into persistently mapped memory and is
+// only valid for the duration of the consumer callback.
+struct ReadbackView {
+    const uint8_t* data = nullptr;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t stride = 0;
+    VkFormat format = VK_FORMAT_UNDEFINED;
+    uint64_t frameIndex = 0;
+};
+
+// Copies frames into a ring of persistently mapped, host-cached buffers so
+// the CPU can consume frame N while later frames are still on the GPU.
+// Each slot has its own command buffer and fence; completed slots are
+// handed to the consumer in submission order.
+class ReadbackRing {
+public:
+    using Consumer = std::function<void(const ReadbackView&)>;
+
+    static constexpr uint32_t kDefaultDepth = 3;
+
+    bool Create(uint32_t width, uint32_t height, Consumer consumer,
+                uint32_t depth = kDefaultDepth);
+    void Destroy();
+
+    // Queues a copy of source, which must be in layout and have been
+    // written at srcStage with srcAccess by earlier submissions. The image
+    // is returned to layout afterwards. Blocks only when every slot is
+    // still in flight.
+    bool Submit(const Frame& source, VkImageLayout layout,
+                VkPipelineStageFlags srcStage, VkAccessFlags srcAccess);
+    // Delivers every readback the GPU has finished, oldest first
+    void Poll();
+
+    bool IsActive() const { return !m_slots.empty(); }
+
+private:
+    struct Slot {
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        void* mapped = nullptr;
+        VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+        VkFence fence = VK_NULL_HANDLE;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        VkFormat format = VK_FORMAT_UNDEFINED;
+        uint64_t frameIndex = 0;
+        bool pending = false;
+    };
+
+    // Delivers the oldest pending slot, waiting for it if wait is set.
+    // Returns false if nothing was delivered.
+    bool DeliverOldest(bool wait);
+
+    std::vector<Slot> m_slots;
+    VkCommandPool m_commandPool = VK_NULL_HANDLE;
+    Consumer m_consumer;
+    uint32_t m_width = 0;
+    uint32_t m_height = 0;
+    VkDeviceSize m_slotSize = 0;
+    uint32_t m_next = 0;
+    uint32_t m_oldest = 0;
+    uint64_t m_frameCounter = 0;
+};
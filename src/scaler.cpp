@@ -1,5 +1,7 @@
 #include "scaler.hpp"
 #include <SDL2/SDL_ttf.h>
+#include <iomanip>
+#include "frame_pacer.hpp"
 
 bool Scaler::Initialize(const ScalerConfig& config) {
     m_config = config;
@@ -55,26 +57,45 @@ bool Scaler::Initialize(const ScalerConfig& config) {
         return false;
     }
 
-    if (!LoadShaders()) {
-        LOG_ERROR("Failed to load shaders");
-        return false;
-    }
-
     if (!CreateComputePipeline()) {
         LOG_ERROR("Failed to create compute pipeline");
         return false;
     }
 
-    if (!CreateDescriptorPool()) {
-        LOG_ERROR("Failed to create descriptor pool");
+    if (!CreateFrameResources()) {
+        LOG_ERROR("Failed to create frame resources");
         return false;
     }
 
-    if (!CreateFrameResources()) {
-        LOG_ERROR("Failed to create frame resources");
+    // Also collects the FrameManager pipelines requested earlier
+    if (!PipelineCache::Get().WaitForPipelines()) {
+        LOG_ERROR("Failed to build compute pipelines");
         return false;
     }
 
+    if (!m_swapchain.Create(m_window, m_config.presentMode, m_config.lowLatency) &&
+        !SetupSurfaceImport()) {
+        LOG_WARN("Swapchain unavailable, displaying frames through CPU readback");
+    }
+
+    // --no-interpolation shows captured frames only
+    m_scheduler.Configure(m_config.enableInterpolation ? m_config.fgMultiplier : 1, m_config.targetFps,
+                          m_config.fgMode, m_config.extrapolationFraction);
+    if (m_scheduler.GetMultiplier() > 1) {
+        LOG_INFO("Frame generation: ", m_scheduler.GetMultiplier(), "x ",
+                 m_config.fgMode == FrameGenerationMode::Extrapolate ? "extrapolated" : "interpolated", ", ",
+                 m_config.targetFps * m_scheduler.GetMultiplier(), " FPS output");
+    }
+
+    bool displayed = m_swapchain.IsValid() || m_surfaceImport.IsImported();
+    if (!displayed || m_readbackConsumer) {
+        auto consumer = [this](const ReadbackView& view) { OnReadback(view); };
+        if (!m_readback.Create(m_config.outputWidth, m_config.outputHeight, consumer)) {
+            LOG_ERROR("Failed to create readback ring");
+            return false;
+        }
+    }
+
     m_initialized = true;
     LOG_INFO("Scaler initialized successfully");
     return true;
@@ -96,39 +117,7 @@ bool Scaler::CreateCommandPool() {
     return true;
 }
 
-bool Scaler::LoadShaders() {
-    VulkanContext& vulkan = VulkanContext::Get();
-    
-    std::ifstream file("shaders/scale.comp.spv", std::ios::ate | std::ios::binary);
-    if (!file.is_open()) {
-        LOG_ERROR("Failed to open scale.comp.spv");
-        return false;
-    }
-
-    size_t fileSize = (size_t) file.tellg();
-    std::vector<char> buffer(fileSize);
-
-    file.seekg(0);
-    file.read(buffer.data(), fileSize);
-    file.close();
-
-    VkShaderModuleCreateInfo createInfo{};
-    createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-    createInfo.codeSize = buffer.size();
-    createInfo.pCode = reinterpret_cast<const uint32_t*>(buffer.data());
-
-    if (vkCreateShaderModule(vulkan.GetDevice(), &createInfo, nullptr, &m_scaleShader) != VK_SUCCESS) {
-        LOG_ERROR("Failed to create scale shader module");
-        return false;
-    }
-
-    return true;
-}
-
 bool Scaler::CreateComputePipeline() {
-    VulkanContext& vulkan = VulkanContext::Get();
-    auto device = vulkan.GetDevice();
-
     std::vector<VkDescriptorSetLayoutBinding> bindings = {
         {
             .binding = 0,
@@ -141,79 +130,100 @@ bool Scaler::CreateComputePipeline() {
             .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
             .descriptorCount = 1,
             .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+        },
+        {
+            .binding = 2,
+            .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+        },
+        {
+            .binding = 3,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
         }
     };
 
-    VkDescriptorSetLayoutCreateInfo layoutInfo{};
-    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
-    layoutInfo.pBindings = bindings.data();
-
-    if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &m_descriptorSetLayout) != VK_SUCCESS) {
-        LOG_ERROR("Failed to create descriptor set layout");
+    if (!m_scaleBindings.Create(bindings, sizeof(ScalePushConstants))) {
+        LOG_ERROR("Failed to create scale pipeline layout");
         return false;
     }
 
-    VkPushConstantRange pushConstantRange{};
-    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
-    pushConstantRange.offset = 0;
-    pushConstantRange.size = sizeof(ScalePushConstants);
-
-    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
-    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    pipelineLayoutInfo.setLayoutCount = 1;
-    pipelineLayoutInfo.pSetLayouts = &m_descriptorSetLayout;
-    pipelineLayoutInfo.pushConstantRangeCount = 1;
-    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
-
-    if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &m_pipelineLayout) != VK_SUCCESS) {
-        LOG_ERROR("Failed to create pipeline layout");
+    // Adds the current frame, its motion field and the tile list
+    std::vector<VkDescriptorSetLayoutBinding> generateBindings = bindings;
+    generateBindings.push_back({
+        .binding = 4,
+        .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+        .descriptorCount = 1,
+        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+    });
+    generateBindings.push_back({
+        .binding = 5,
+        .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+        .descriptorCount = 1,
+        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+    });
+    generateBindings.push_back({
+        .binding = 6,
+        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+        .descriptorCount = 1,
+        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+    });
+
+    if (!m_generateBindings.Create(generateBindings, sizeof(GeneratePushConstants))) {
+        LOG_ERROR("Failed to create frame generation pipeline layout");
         return false;
     }
 
-    VkComputePipelineCreateInfo pipelineInfo{};
-    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
-    pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
-    pipelineInfo.stage.module = m_scaleShader;
-    pipelineInfo.stage.pName = "main";
-    pipelineInfo.layout = m_pipelineLayout;
-
-    if (vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_scalePipeline) != VK_SUCCESS) {
-        LOG_ERROR("Failed to create compute pipeline");
-        return false;
+    const auto& params = FrameManager::Get().GetKernelParams();
+    PipelineCache::Get().RequestComputePipeline(ScalePipelineDesc(params, false));
+    if (m_config.enableInterpolation) {
+        PipelineCache::Get().RequestComputePipeline(ScalePipelineDesc(params, true));
     }
 
     return true;
 }
 
-bool Scaler::CreateDescriptorPool() {
-    VulkanContext& vulkan = VulkanContext::Get();
-    auto device = vulkan.GetDevice();
-
-    std::vector<VkDescriptorPoolSize> poolSizes = {
-        {
-            .type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-            .descriptorCount = 1,
-        },
-        {
-            .type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
-            .descriptorCount = 1,
+ComputePipelineDesc Scaler::ScalePipelineDesc(const KernelParams& params, bool generate) const {
+    bool unformatted = VulkanContext::Get().HasStorageWriteWithoutFormat();
+    const uint32_t* code;
+    size_t codeSize;
+    if (generate) {
+        code = unformatted ? shaders::kScaleGenerateUnformatted : shaders::kScaleGenerate;
+        codeSize = unformatted ? sizeof(shaders::kScaleGenerateUnformatted) : sizeof(shaders::kScaleGenerate);
+    } else {
+        code = unformatted ? shaders::kScaleUnformatted : shaders::kScale;
+        codeSize = unformatted ? sizeof(shaders::kScaleUnformatted) : sizeof(shaders::kScale);
+    }
+    return {
+        .name = generate ? "scale_generate" : "scale",
+        .code = code,
+        .codeSize = codeSize,
+        .layout = generate ? m_generateBindings.GetPipelineLayout() : m_scaleBindings.GetPipelineLayout(),
+        .specialization = {
+            params.scaleWorkgroup.x,
+            params.scaleWorkgroup.y,
+            static_cast<uint32_t>(params.lanczosRadius)
         }
     };
+}
 
-    VkDescriptorPoolCreateInfo poolInfo{};
-    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
-    poolInfo.pPoolSizes = poolSizes.data();
-    poolInfo.maxSets = 1;
-
-    if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &m_descriptorPool) != VK_SUCCESS) {
-        LOG_ERROR("Failed to create descriptor pool");
-        return false;
+VkPipeline Scaler::GetScalePipeline(bool generate) {
+    // Kernel parameters live in FrameManager; pick up the matching variant
+    // whenever they change
+    const auto& params = FrameManager::Get().GetKernelParams();
+    if (!(m_scaleParams == params)) {
+        m_scaleParams = params;
+        m_scalePipeline = VK_NULL_HANDLE;
+        m_generatePipeline = VK_NULL_HANDLE;
     }
 
-    return true;
+    VkPipeline& pipeline = generate ? m_generatePipeline : m_scalePipeline;
+    if (pipeline == VK_NULL_HANDLE) {
+        pipeline = PipelineCache::Get().GetComputePipeline(ScalePipelineDesc(params, generate));
+    }
+    return pipeline;
 }
 
 bool Scaler::CreateFrameResources() {
@@ -232,150 +242,387 @@ bool Scaler::CreateFrameResources() {
         return false;
     }
 
-    VkDescriptorSetAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-    allocInfo.descriptorPool = m_descriptorPool;
-    allocInfo.descriptorSetCount = 1;
-    allocInfo.pSetLayouts = &m_descriptorSetLayout;
+    if (!CreateFrameSlots()) {
+        LOG_ERROR("Failed to create frame synchronization objects");
+        return false;
+    }
 
-    if (vkAllocateDescriptorSets(vulkan.GetDevice(), &allocInfo, &m_descriptorSet) != VK_SUCCESS) {
-        LOG_ERROR("Failed to allocate descriptor set");
+    if (!m_overlay.Create(m_font, kFramesInFlight)) {
+        LOG_ERROR("Failed to create stats overlay");
         return false;
     }
 
-    VkCommandBufferAllocateInfo cmdAllocInfo{};
-    cmdAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    cmdAllocInfo.commandPool = m_commandPool;
-    cmdAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    cmdAllocInfo.commandBufferCount = 1;
+    return true;
+}
 
-    if (vkAllocateCommandBuffers(vulkan.GetDevice(), &cmdAllocInfo, &m_commandBuffer) != VK_SUCCESS) {
-        LOG_ERROR("Failed to allocate command buffer");
-        return false;
+bool Scaler::CreateFrameSlots() {
+    auto device = VulkanContext::Get().GetDevice();
+
+    for (auto& slot : m_frameSlots) {
+        VkCommandBufferAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.commandPool = m_commandPool;
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInfo.commandBufferCount = 1;
+
+        if (vkAllocateCommandBuffers(device, &allocInfo, &slot.commandBuffer) != VK_SUCCESS) {
+            LOG_ERROR("Failed to allocate frame command buffer");
+            return false;
+        }
+
+        VkFenceCreateInfo fenceInfo{};
+        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+
+        VkSemaphoreCreateInfo semaphoreInfo{};
+        semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+        if (vkCreateFence(device, &fenceInfo, nullptr, &slot.fence) != VK_SUCCESS ||
+            vkCreateSemaphore(device, &semaphoreInfo, nullptr, &slot.imageAcquired) != VK_SUCCESS) {
+            LOG_ERROR("Failed to create frame synchronization objects");
+            return false;
+        }
+    }
+
+    // GPU time per frame feeds the frame generation budget; without
+    // timestamps generated frames are never dropped
+    auto& vulkan = VulkanContext::Get();
+    if (vulkan.GetDeviceProperties().limits.timestampComputeAndGraphics &&
+        vulkan.GetTimestampValidBits() > 0) {
+        VkQueryPoolCreateInfo queryInfo{};
+        queryInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        queryInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        queryInfo.queryCount = kFramesInFlight * 2;
+
+        if (vkCreateQueryPool(device, &queryInfo, nullptr, &m_queryPool) != VK_SUCCESS) {
+            LOG_WARN("Failed to create frame timing queries");
+            m_queryPool = VK_NULL_HANDLE;
+        }
     }
 
     return true;
 }
 
-bool Scaler::ScaleFrame(const Frame& input, Frame& output) {
-    // Add debug logging
-    LOG_INFO("ScaleFrame - Input: ", input.width, "x", input.height,
-             " Output: ", output.width, "x", output.height);
+void Scaler::CollectGpuTime(uint32_t slotIndex) {
+    FrameSlot& slot = m_frameSlots[slotIndex];
+    if (!slot.timed) {
+        return;
+    }
+    slot.timed = false;
+
+    // The slot's fence has signaled, so the results are available
+    uint64_t timestamps[2] = {};
+    if (vkGetQueryPoolResults(VulkanContext::Get().GetDevice(), m_queryPool, slotIndex * 2, 2,
+                              sizeof(timestamps), timestamps, sizeof(uint64_t),
+                              VK_QUERY_RESULT_64_BIT) != VK_SUCCESS) {
+        return;
+    }
 
-    VulkanContext& vulkan = VulkanContext::Get();
-    
-    VkDescriptorImageInfo inputInfo{};
-    inputInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-    inputInfo.imageView = input.view;
-    inputInfo.sampler = m_sampler;
+    m_scheduler.ReportGpuTime(slot.generated,
+                              VulkanContext::Get().TimestampIntervalMs(timestamps[0], timestamps[1]));
+}
 
-    VkDescriptorImageInfo outputInfo{};
-    outputInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
-    outputInfo.imageView = output.view;
+const MotionField* Scaler::RecordFrameGeneration(VkCommandBuffer commandBuffer) {
+    auto& frameManager = FrameManager::Get();
+    FrameSlot& slot = m_frameSlots[m_frameSlot];
 
-    std::vector<VkWriteDescriptorSet> descriptorWrites = {
-        {
-            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-            .dstSet = m_descriptorSet,
-            .dstBinding = 0,
-            .dstArrayElement = 0,
-            .descriptorCount = 1,
-            .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-            .pImageInfo = &inputInfo,
-        },
-        {
-            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-            .dstSet = m_descriptorSet,
-            .dstBinding = 1,
-            .dstArrayElement = 0,
-            .descriptorCount = 1,
-            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
-            .pImageInfo = &outputInfo,
+    // When the scale writes straight into the swapchain image, the interval
+    // also covers waiting for that image, so a display that cannot keep up
+    // with the output rate drops generation too
+    if (m_queryPool != VK_NULL_HANDLE) {
+        vkCmdResetQueryPool(commandBuffer, m_queryPool, m_frameSlot * 2, 2);
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_queryPool, m_frameSlot * 2);
+    }
+
+    slot.generated = false;
+    if (!m_scheduled.generate) {
+        return nullptr;
+    }
+
+    // Motion is searched once per source pair; every generated frame of the
+    // pair then only costs its fused warp and scale
+    if (m_scheduled.estimateMotion) {
+        m_motion = nullptr;
+        if (!frameManager.ResolvePipelines() || GetScalePipeline(true) == VK_NULL_HANDLE) {
+            return nullptr;
         }
-    };
+        m_motion = frameManager.RecordMotionEstimation(commandBuffer, m_previousFrame, m_currentFrame);
+    }
+
+    slot.generated = m_motion != nullptr;
+    return m_motion;
+}
+
+void Scaler::EndGpuTime(VkCommandBuffer commandBuffer) {
+    if (m_queryPool != VK_NULL_HANDLE) {
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_queryPool, m_frameSlot * 2 + 1);
+        m_frameSlots[m_frameSlot].timed = true;
+    }
+}
+
+bool Scaler::PresentFrame() {
+    auto& vulkan = VulkanContext::Get();
+    auto& frameManager = FrameManager::Get();
+    auto device = vulkan.GetDevice();
+
+    if (GetScalePipeline() == VK_NULL_HANDLE) {
+        LOG_ERROR("Scale pipeline not available");
+        return false;
+    }
+
+    FrameSlot& slot = m_frameSlots[m_frameSlot];
+    vkWaitForFences(device, 1, &slot.fence, VK_TRUE, UINT64_MAX);
+    CollectGpuTime(m_frameSlot);
+
+    uint32_t imageIndex = 0;
+    if (!m_swapchain.AcquireNextImage(slot.imageAcquired, imageIndex)) {
+        return false;
+    }
+    const Frame& target = m_swapchain.GetImage(imageIndex);
 
-    vkUpdateDescriptorSets(vulkan.GetDevice(), 
-        static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(),
-        0, nullptr);
+    vkResetFences(device, 1, &slot.fence);
+    vkResetCommandBuffer(slot.commandBuffer, 0);
 
     VkCommandBufferBeginInfo beginInfo{};
     beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
     beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(slot.commandBuffer, &beginInfo);
+    const MotionField* motion = RecordFrameGeneration(slot.commandBuffer);
+
+    // Source stages match the acquire semaphore's wait stage so the layout
+    // transitions happen after the presentation engine releases the image
+    // Readback consumers copy from the output frame, so it has to be
+    // written even when the swapchain could take the result directly
+    bool directOutput = m_swapchain.SupportsStorage() && !m_readback.IsActive();
+
+    VkPipelineStageFlags waitStage;
+    if (directOutput) {
+        waitStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+        frameManager.TransitionImage(slot.commandBuffer, target.image,
+            VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+            0, VK_ACCESS_SHADER_WRITE_BIT,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+        RecordOutput(slot.commandBuffer, motion, target);
+
+        frameManager.TransitionImage(slot.commandBuffer, target.image,
+            VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+            VK_ACCESS_SHADER_WRITE_BIT, 0,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+    } else {
+        waitStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+        // Waits for the previous frame's blit and readback to stop reading
+        frameManager.TransitionImage(slot.commandBuffer, m_outputFrame.image,
+            VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+            0, VK_ACCESS_SHADER_WRITE_BIT,
+            VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+        RecordOutput(slot.commandBuffer, motion, m_outputFrame);
+
+        frameManager.TransitionImage(slot.commandBuffer, m_outputFrame.image,
+            VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+        frameManager.TransitionImage(slot.commandBuffer, target.image,
+            VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            0, VK_ACCESS_TRANSFER_WRITE_BIT,
+            VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+        // The blit also converts channel order to the swapchain format
+        VkImageBlit region{};
+        region.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.srcSubresource.layerCount = 1;
+        region.srcOffsets[1] = {static_cast<int32_t>(m_outputFrame.width),
+                                static_cast<int32_t>(m_outputFrame.height), 1};
+        region.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.dstSubresource.layerCount = 1;
+        region.dstOffsets[1] = {static_cast<int32_t>(target.width),
+                                static_cast<int32_t>(target.height), 1};
+
+        vkCmdBlitImage(slot.commandBuffer,
+            m_outputFrame.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            target.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            1, &region, VK_FILTER_LINEAR);
+
+        frameManager.TransitionImage(slot.commandBuffer, target.image,
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+            VK_ACCESS_TRANSFER_WRITE_BIT, 0,
+            VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+    }
 
-    vkBeginCommandBuffer(m_commandBuffer, &beginInfo);
-
-    VkImageMemoryBarrier barrier{};
-    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    barrier.image = input.image;
-    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    barrier.subresourceRange.baseMipLevel = 0;
-    barrier.subresourceRange.levelCount = 1;
-    barrier.subresourceRange.baseArrayLayer = 0;
-    barrier.subresourceRange.layerCount = 1;
-    barrier.srcAccessMask = 0;
-    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-    vkCmdPipelineBarrier(m_commandBuffer,
-        VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
-        0,
-        0, nullptr,
-        0, nullptr,
-        1, &barrier);
-
-    barrier.image = output.image;
-    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
-    barrier.srcAccessMask = 0;
-    barrier.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
-
-    vkCmdPipelineBarrier(m_commandBuffer,
-        VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
-        0,
-        0, nullptr,
-        0, nullptr,
-        1, &barrier);
-
-    vkCmdBindPipeline(m_commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_scalePipeline);
-    vkCmdBindDescriptorSets(m_commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE,
-        m_pipelineLayout, 0, 1, &m_descriptorSet, 0, nullptr);
+    EndGpuTime(slot.commandBuffer);
+    if (vkEndCommandBuffer(slot.commandBuffer) != VK_SUCCESS) {
+        LOG_ERROR("Failed to record command buffer");
+        return false;
+    }
 
+    VkSemaphore renderFinished = m_swapchain.GetRenderFinished(imageIndex);
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.waitSemaphoreCount = 1;
+    submitInfo.pWaitSemaphores = &slot.imageAcquired;
+    submitInfo.pWaitDstStageMask = &waitStage;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &slot.commandBuffer;
+    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.pSignalSemaphores = &renderFinished;
+
+    if (vulkan.Submit(submitInfo, slot.fence) != VK_SUCCESS) {
+        LOG_ERROR("Failed to submit command buffer");
+        return false;
+    }
+
+    uint32_t framesInFlight = m_config.lowLatency ? 1 : kFramesInFlight;
+    m_frameSlot = (m_frameSlot + 1) % framesInFlight;
+    if (!m_swapchain.Present(imageIndex)) {
+        return false;
+    }
+
+    if (m_readback.IsActive()) {
+        if (!m_readback.Submit(m_outputFrame, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                               VK_PIPELINE_STAGE_TRANSFER_BIT, 0)) {
+            return false;
+        }
+        m_readback.Poll();
+    }
+    return true;
+}
+
+void Scaler::WaitForPreviousFrame() {
+    if (m_swapchain.WaitForQueuedPresents(0)) {
+        return;
+    }
+
+    // Without present wait the best available bound is GPU completion
+    auto& slot = m_frameSlots[m_frameSlot];
+    vkWaitForFences(VulkanContext::Get().GetDevice(), 1, &slot.fence, VK_TRUE, UINT64_MAX);
+}
+
+void Scaler::RecordScale(VkCommandBuffer commandBuffer, const Frame& input, const Frame& output) {
+    // Frame slots are only reused once their previous submission finished,
+    // so the slot's glyph buffer is free to rewrite
+    m_overlay.Update(m_frameSlot);
+
+    DescriptorInfo descriptors[4]{};
+    descriptors[0].image.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    descriptors[0].image.imageView = input.view;
+    descriptors[0].image.sampler = m_sampler;
+    descriptors[1].image.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+    descriptors[1].image.imageView = output.view;
+    descriptors[2].image.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    descriptors[2].image.imageView = m_overlay.GetAtlasView();
+    descriptors[2].image.sampler = m_sampler;
+    descriptors[3].buffer.buffer = m_overlay.GetGlyphBuffer(m_frameSlot);
+    descriptors[3].buffer.range = VK_WHOLE_SIZE;
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, GetScalePipeline());
+    m_scaleBindings.Bind(commandBuffer, descriptors);
+
+    const int32_t* bounds = m_overlay.GetBounds();
     ScalePushConstants pushConstants{
         .inputSize = {static_cast<int32_t>(input.width), static_cast<int32_t>(input.height)},
-        .outputSize = {static_cast<int32_t>(output.width), static_cast<int32_t>(output.height)}
+        .outputSize = {static_cast<int32_t>(output.width), static_cast<int32_t>(output.height)},
+        .overlayBounds = {bounds[0], bounds[1], bounds[2], bounds[3]},
+        .overlayGlyphs = static_cast<int32_t>(m_overlay.GetGlyphCount())
+    };
+
+    vkCmdPushConstants(commandBuffer, m_scaleBindings.GetPipelineLayout(),
+        VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pushConstants), &pushConstants);
+
+    const auto& workgroup = m_scaleParams.scaleWorkgroup;
+    vkCmdDispatch(commandBuffer,
+        (output.width + workgroup.x - 1) / workgroup.x,
+        (output.height + workgroup.y - 1) / workgroup.y, 1);
+}
+
+void Scaler::RecordOutput(VkCommandBuffer commandBuffer, const MotionField* motion, const Frame& output) {
+    if (motion) {
+        RecordGeneratedScale(commandBuffer, *motion, output);
+    } else {
+        RecordScale(commandBuffer, m_currentFrame, output);
+    }
+}
+
+void Scaler::RecordGeneratedScale(VkCommandBuffer commandBuffer, const MotionField& motion,
+                                  const Frame& output) {
+    m_overlay.Update(m_frameSlot);
+
+    DescriptorInfo descriptors[7]{};
+    descriptors[0].image.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    descriptors[0].image.imageView = m_previousFrame.view;
+    descriptors[0].image.sampler = m_sampler;
+    descriptors[1].image.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+    descriptors[1].image.imageView = output.view;
+    descriptors[2].image.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    descriptors[2].image.imageView = m_overlay.GetAtlasView();
+    descriptors[2].image.sampler = m_sampler;
+    descriptors[3].buffer.buffer = m_overlay.GetGlyphBuffer(m_frameSlot);
+    descriptors[3].buffer.range = VK_WHOLE_SIZE;
+    descriptors[4].image.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    descriptors[4].image.imageView = m_currentFrame.view;
+    descriptors[4].image.sampler = m_sampler;
+    descriptors[5].image.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+    descriptors[5].image.imageView = motion.vectors.view;
+    descriptors[5].image.sampler = FrameManager::Get().GetPointSampler();
+    descriptors[6].buffer = {motion.tileList, 0, VK_WHOLE_SIZE};
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, GetScalePipeline(true));
+    m_generateBindings.Bind(commandBuffer, descriptors);
+
+    const int32_t* bounds = m_overlay.GetBounds();
+    GeneratePushConstants pushConstants{
+        .scale = {
+            .inputSize = {static_cast<int32_t>(m_currentFrame.width),
+                          static_cast<int32_t>(m_currentFrame.height)},
+            .outputSize = {static_cast<int32_t>(output.width), static_cast<int32_t>(output.height)},
+            .overlayBounds = {bounds[0], bounds[1], bounds[2], bounds[3]},
+            .overlayGlyphs = static_cast<int32_t>(m_overlay.GetGlyphCount())
+        },
+        .factor = m_scheduled.factor,
+        .blockSize = static_cast<int32_t>(motion.blockSize)
     };
 
-    vkCmdPushConstants(m_commandBuffer, m_pipelineLayout,
+    vkCmdPushConstants(commandBuffer, m_generateBindings.GetPipelineLayout(),
         VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pushConstants), &pushConstants);
 
-    uint32_t groupsX = (output.width + 15) / 16;
-    uint32_t groupsY = (output.height + 15) / 16;
+    const auto& workgroup = m_scaleParams.scaleWorkgroup;
+    vkCmdDispatch(commandBuffer,
+        (output.width + workgroup.x - 1) / workgroup.x,
+        (output.height + workgroup.y - 1) / workgroup.y, 1);
+}
 
-    // Log dispatch parameters
-    LOG_INFO("Dispatch groups: ", groupsX, "x", groupsY);
-    
-    vkCmdDispatch(m_commandBuffer, groupsX, groupsY, 1);
-
-    barrier.image = output.image;
-    barrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
-    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
-    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-    vkCmdPipelineBarrier(m_commandBuffer,
-        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
-        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-        0,
-        0, nullptr,
-        0, nullptr,
-        1, &barrier);
-
-    if (vkEndCommandBuffer(m_commandBuffer) != VK_SUCCESS) {
+bool Scaler::ReadbackFrame() {
+    auto& vulkan = VulkanContext::Get();
+    auto& frameManager = FrameManager::Get();
+
+    if (GetScalePipeline() == VK_NULL_HANDLE) {
+        LOG_ERROR("Scale pipeline not available");
+        return false;
+    }
+
+    FrameSlot& slot = m_frameSlots[m_frameSlot];
+    vkWaitForFences(vulkan.GetDevice(), 1, &slot.fence, VK_TRUE, UINT64_MAX);
+    CollectGpuTime(m_frameSlot);
+    vkResetFences(vulkan.GetDevice(), 1, &slot.fence);
+    vkResetCommandBuffer(slot.commandBuffer, 0);
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(slot.commandBuffer, &beginInfo);
+    const MotionField* motion = RecordFrameGeneration(slot.commandBuffer);
+
+    // Waits for the previous frame's readback copy before overwriting
+    frameManager.TransitionImage(slot.commandBuffer, m_outputFrame.image,
+        VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+        0, VK_ACCESS_SHADER_WRITE_BIT,
+        VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+    RecordOutput(slot.commandBuffer, motion, m_outputFrame);
+
+    EndGpuTime(slot.commandBuffer);
+    if (vkEndCommandBuffer(slot.commandBuffer) != VK_SUCCESS) {
         LOG_ERROR("Failed to record command buffer");
         return false;
     }
@@ -383,175 +630,189 @@ bool Scaler::ScaleFrame(const Frame& input, Frame& output) {
     VkSubmitInfo submitInfo{};
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
     submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = &m_commandBuffer;
+    submitInfo.pCommandBuffers = &slot.commandBuffer;
 
-    if (vkQueueSubmit(vulkan.GetComputeQueue(), 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+    if (vulkan.Submit(submitInfo, slot.fence) != VK_SUCCESS) {
         LOG_ERROR("Failed to submit command buffer");
         return false;
     }
+    m_frameSlot = (m_frameSlot + 1) % kFramesInFlight;
 
-    vkQueueWaitIdle(vulkan.GetComputeQueue());
+    if (!m_readback.Submit(m_outputFrame, VK_IMAGE_LAYOUT_GENERAL,
+                           VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT)) {
+        return false;
+    }
+
+    m_readback.Poll();
     return true;
 }
 
-bool Scaler::ProcessFrame() {
-    if (!m_initialized) {
-        LOG_ERROR("Scaler not initialized");
+bool Scaler::SetupSurfaceImport() {
+    auto& vulkan = VulkanContext::Get();
+
+    SDL_Surface* windowSurface = SDL_GetWindowSurface(m_window);
+    if (!windowSurface || !vulkan.HasExternalMemoryHost() || !vulkan.HasStorageWriteWithoutFormat()) {
         return false;
     }
 
-    // Handle SDL events properly
-    SDL_Event event;
-    while (SDL_PollEvent(&event)) {
-        switch (event.type) {
-            case SDL_QUIT:
-                LOG_INFO("Received SDL_QUIT event");
-                return false;
-                
-            case SDL_WINDOWEVENT:
-                if (event.window.event == SDL_WINDOWEVENT_CLOSE) {
-                    LOG_INFO("Received window close event");
-                    return false;
-                }
-                break;
-        }
+    // The scale kernel writes the surface's own byte order, so SDL has
+    // nothing to convert
+    VkFormat format = SurfaceImport::FormatFor(windowSurface);
+    if (format == VK_FORMAT_UNDEFINED) {
+        return false;
     }
 
-    static int frameCount = 0;
-    if (frameCount++ % 60 == 0) {  // Log every 60 frames
-        LOG_INFO("Current FPS: ", m_currentFps);
-        LOG_INFO("Input Resolution: ", m_config.inputWidth, "x", m_config.inputHeight);
-        LOG_INFO("Target Resolution: ", m_config.outputWidth, "x", m_config.outputHeight);
-        LOG_INFO("Interpolation: ", m_config.enableInterpolation ? "Enabled" : "Disabled");
+    VkFormatProperties formatProperties;
+    vkGetPhysicalDeviceFormatProperties(vulkan.GetPhysicalDevice(), format, &formatProperties);
+    if (!(formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT)) {
+        return false;
     }
 
-    auto currentTime = std::chrono::steady_clock::now();
-    m_frameTimings.push(currentTime);
-
-    while (m_frameTimings.size() > 60) {
-        m_frameTimings.pop();
+    if (static_cast<uint32_t>(windowSurface->w) != m_config.outputWidth ||
+        static_cast<uint32_t>(windowSurface->h) != m_config.outputHeight) {
+        return false;
     }
 
-    if (m_frameTimings.size() > 1) {
-        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
-            m_frameTimings.back() - m_frameTimings.front()).count();
-        m_currentFps = 1000.0f * (m_frameTimings.size() - 1) / duration;
+    if (!m_surfaceImport.Import(windowSurface)) {
+        return false;
     }
 
-    if (m_currentFrame.image == VK_NULL_HANDLE) {
-        LOG_INFO("Creating current frame buffer");
-        if (!FrameManager::Get().CreateFrame(m_currentFrame, m_config.inputWidth, m_config.inputHeight)) {
-            LOG_ERROR("Failed to create current frame");
-            return false;
-        }
-    }
+    m_outputFormat = format;
+    return true;
+}
 
-    if (m_config.enableInterpolation && m_previousFrame.image == VK_NULL_HANDLE) {
-        LOG_INFO("Creating previous frame buffer");
-        if (!FrameManager::Get().CreateFrame(m_previousFrame, m_config.inputWidth, m_config.inputHeight)) {
-            LOG_ERROR("Failed to create previous frame");
-            return false;
-        }
+bool Scaler::WriteWindowSurface() {
+    auto& vulkan = VulkanContext::Get();
+    auto& frameManager = FrameManager::Get();
+    auto device = vulkan.GetDevice();
+
+    SDL_Surface* windowSurface = SDL_GetWindowSurface(m_window);
+    if (!windowSurface) {
+        LOG_ERROR("Failed to get window surface: ", SDL_GetError());
+        return false;
     }
 
-    if (m_outputFrame.image == VK_NULL_HANDLE) {
-        LOG_INFO("Creating output frame buffer");
-        if (!FrameManager::Get().CreateFrame(m_outputFrame, m_config.outputWidth, m_config.outputHeight)) {
-            LOG_ERROR("Failed to create output frame");
+    if (!m_surfaceImport.Matches(windowSurface)) {
+        vkDeviceWaitIdle(device);
+        if (!m_surfaceImport.Import(windowSurface) || m_surfaceImport.GetFormat() != m_outputFormat ||
+            windowSurface->w != static_cast<int>(m_outputFrame.width) ||
+            windowSurface->h != static_cast<int>(m_outputFrame.height)) {
+            LOG_ERROR("Window surface changed and could not be imported again");
             return false;
         }
     }
 
-    LOG_INFO("Attempting to capture frame...");
-    if (!WindowCapture::Get().CaptureFrame(m_currentFrame)) {
-        LOG_ERROR("Failed to capture frame");
+    if (GetScalePipeline() == VK_NULL_HANDLE) {
+        LOG_ERROR("Scale pipeline not available");
         return false;
     }
-    LOG_INFO("Frame captured successfully");
 
-    LOG_INFO("Scaling frame...");
-    if (!ScaleFrame(m_currentFrame, m_outputFrame)) {
-        LOG_ERROR("Failed to scale frame");
-        return false;
-    }
-    LOG_INFO("Frame scaled successfully");
+    FrameSlot& slot = m_frameSlots[m_frameSlot];
+    vkWaitForFences(device, 1, &slot.fence, VK_TRUE, UINT64_MAX);
+    CollectGpuTime(m_frameSlot);
+    vkResetFences(device, 1, &slot.fence);
+    vkResetCommandBuffer(slot.commandBuffer, 0);
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(slot.commandBuffer, &beginInfo);
+    const MotionField* motion = RecordFrameGeneration(slot.commandBuffer);
 
-    // Create staging buffer for reading back the image data
-    VkBuffer stagingBuffer;
-    VkDeviceMemory stagingMemory;
-    VkDeviceSize bufferSize = m_config.outputWidth * m_config.outputHeight * 4;
+    frameManager.TransitionImage(slot.commandBuffer, m_outputFrame.image,
+        VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+        0, VK_ACCESS_SHADER_WRITE_BIT,
+        VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
 
-    if (!FrameManager::Get().CreateStagingBuffer(stagingBuffer, stagingMemory, bufferSize)) {
-        LOG_ERROR("Failed to create staging buffer");
-        return false;
-    }
+    RecordOutput(slot.commandBuffer, motion, m_outputFrame);
 
-    // Copy image data to staging buffer
-    VkCommandBuffer commandBuffer = FrameManager::Get().BeginSingleTimeCommands();
-    
-    VkImageMemoryBarrier barrier{};
-    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-    barrier.oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    barrier.image = m_outputFrame.image;
-    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    barrier.subresourceRange.baseMipLevel = 0;
-    barrier.subresourceRange.levelCount = 1;
-    barrier.subresourceRange.baseArrayLayer = 0;
-    barrier.subresourceRange.layerCount = 1;
-    barrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
-    barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-
-    vkCmdPipelineBarrier(commandBuffer,
-        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-        VK_PIPELINE_STAGE_TRANSFER_BIT,
-        0,
-        0, nullptr,
-        0, nullptr,
-        1, &barrier);
+    frameManager.TransitionImage(slot.commandBuffer, m_outputFrame.image,
+        VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+        VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
 
     VkBufferImageCopy region{};
+    region.bufferRowLength = m_surfaceImport.GetRowLength();
     region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
     region.imageSubresource.layerCount = 1;
-    region.imageExtent.width = m_config.outputWidth;
-    region.imageExtent.height = m_config.outputHeight;
-    region.imageExtent.depth = 1;
+    region.imageExtent = {m_outputFrame.width, m_outputFrame.height, 1};
+
+    vkCmdCopyImageToBuffer(slot.commandBuffer, m_outputFrame.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                           m_surfaceImport.GetBuffer(), 1, &region);
+
+    VkBufferMemoryBarrier hostBarrier{};
+    hostBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    hostBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    hostBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    hostBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    hostBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    hostBarrier.buffer = m_surfaceImport.GetBuffer();
+    hostBarrier.size = VK_WHOLE_SIZE;
+
+    vkCmdPipelineBarrier(slot.commandBuffer,
+        VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+        0, 0, nullptr, 1, &hostBarrier, 0, nullptr);
+
+    EndGpuTime(slot.commandBuffer);
+    if (vkEndCommandBuffer(slot.commandBuffer) != VK_SUCCESS) {
+        LOG_ERROR("Failed to record command buffer");
+        return false;
+    }
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &slot.commandBuffer;
 
-    vkCmdCopyImageToBuffer(commandBuffer,
-        m_outputFrame.image,
-        VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-        stagingBuffer,
-        1,
-        &region);
+    if (vulkan.Submit(submitInfo, slot.fence) != VK_SUCCESS) {
+        LOG_ERROR("Failed to submit command buffer");
+        return false;
+    }
+    m_frameSlot = (m_frameSlot + 1) % kFramesInFlight;
 
-    FrameManager::Get().EndSingleTimeCommands(commandBuffer);
+    if (m_readback.IsActive()) {
+        if (!m_readback.Submit(m_outputFrame, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                               VK_PIPELINE_STAGE_TRANSFER_BIT, 0)) {
+            return false;
+        }
+        m_readback.Poll();
+    }
 
-    // Ensure compute operations are complete
-    vkQueueWaitIdle(VulkanContext::Get().GetComputeQueue());
+    // The surface has a single buffer that SDL hands to the window system
+    // as soon as it is updated
+    vkWaitForFences(device, 1, &slot.fence, VK_TRUE, UINT64_MAX);
 
-    // Map the staging buffer and create SDL surface
-    void* data;
-    vkMapMemory(VulkanContext::Get().GetDevice(), stagingMemory, 0, bufferSize, 0, &data);
+    if (SDL_UpdateWindowSurface(m_window) != 0) {
+        LOG_ERROR("Failed to update window surface: ", SDL_GetError());
+    }
+    return true;
+}
 
+void Scaler::OnReadback(const ReadbackView& view) {
+    if (!m_swapchain.IsValid() && !m_surfaceImport.IsImported()) {
+        ShowReadback(view);
+    }
+    if (m_readbackConsumer) {
+        m_readbackConsumer(view);
+    }
+}
+
+void Scaler::ShowReadback(const ReadbackView& view) {
     SDL_Surface* surface = SDL_CreateRGBSurfaceFrom(
-        data,
-        m_config.outputWidth,
-        m_config.outputHeight,
+        const_cast<uint8_t*>(view.data),
+        view.width,
+        view.height,
         32,
-        m_config.outputWidth * 4,
-        0x00FF0000,  // B mask
-        0x0000FF00,  // G mask
+        view.stride,
         0x000000FF,  // R mask
+        0x0000FF00,  // G mask
+        0x00FF0000,  // B mask
         0xFF000000   // A mask
     );
 
     if (!surface) {
         LOG_ERROR("Failed to create SDL surface: ", SDL_GetError());
-        vkUnmapMemory(VulkanContext::Get().GetDevice(), stagingMemory);
-        FrameManager::Get().DestroyStagingBuffer(stagingBuffer, stagingMemory);
-        return false;
+        return;
     }
 
     // Get the window surface
@@ -559,65 +820,164 @@ bool Scaler::ProcessFrame() {
     if (!windowSurface) {
         LOG_ERROR("Failed to get window surface: ", SDL_GetError());
         SDL_FreeSurface(surface);
-        vkUnmapMemory(VulkanContext::Get().GetDevice(), stagingMemory);
-        FrameManager::Get().DestroyStagingBuffer(stagingBuffer, stagingMemory);
-        return false;
+        return;
     }
 
     if (SDL_MUSTLOCK(windowSurface)) {
         if (SDL_LockSurface(windowSurface) < 0) {
             LOG_ERROR("Failed to lock window surface: ", SDL_GetError());
-            return false;
+            SDL_FreeSurface(surface);
+            return;
         }
     }
 
     // Blit the surface to the window surface
     if (SDL_BlitSurface(surface, NULL, windowSurface, NULL) != 0) {
         LOG_ERROR("Failed to blit surface: ", SDL_GetError());
-        SDL_FreeSurface(surface);
-        vkUnmapMemory(VulkanContext::Get().GetDevice(), stagingMemory);
-        FrameManager::Get().DestroyStagingBuffer(stagingBuffer, stagingMemory);
+    }
+
+    if (SDL_MUSTLOCK(windowSurface)) {
+        SDL_UnlockSurface(windowSurface);
+    }
+
+    // Update the window with the new content
+    if (SDL_UpdateWindowSurface(m_window) != 0) {
+        LOG_ERROR("Failed to update window surface: ", SDL_GetError());
+    }
+
+    SDL_FreeSurface(surface);
+}
+
+bool Scaler::ProcessFrame() {
+    if (!m_initialized) {
+        LOG_ERROR("Scaler not initialized");
         return false;
     }
 
-    // Prepare stats text
+    // Handle SDL events properly
+    SDL_Event event;
+    while (SDL_PollEvent(&event)) {
+        switch (event.type) {
+            case SDL_QUIT:
+                LOG_INFO("Received SDL_QUIT event");
+                return false;
+                
+            case SDL_WINDOWEVENT:
+                if (event.window.event == SDL_WINDOWEVENT_CLOSE) {
+                    LOG_INFO("Received window close event");
+                    return false;
+                }
+                break;
+        }
+    }
+
+    static int frameCount = 0;
+    if (frameCount++ % 60 == 0) {  // Log every 60 frames
+        LOG_INFO("Current FPS: ", m_currentFps);
+        LOG_INFO("Input Resolution: ", m_config.inputWidth, "x", m_config.inputHeight);
+        LOG_INFO("Target Resolution: ", m_config.outputWidth, "x", m_config.outputHeight);
+        LOG_INFO("Interpolation: ", m_config.enableInterpolation ? "Enabled" : "Disabled");
+
+        SchedulerStats scheduler = m_scheduler.TakeStats();
+        if (m_scheduler.GetMultiplier() > 1) {
+            LOG_INFO("Frame generation ", m_scheduler.GetMultiplier(), "x: ", scheduler.generated,
+                     " generated, ", scheduler.dropped, " dropped, source interval ",
+                     scheduler.sourceIntervalMs, " ms, generation cost ", scheduler.generationCostMs, " ms");
+        }
+
+        PresentDelayStats delay;
+        if (m_swapchain.TakePresentDelay(delay)) {
+            LOG_INFO("Present delay (", PresentModeName(m_swapchain.GetPresentMode()), "): avg ",
+                     delay.averageMs, " ms, min ", delay.minMs, " ms, max ", delay.maxMs,
+                     " ms over ", delay.count, " frames");
+        }
+    }
+
+    auto currentTime = std::chrono::steady_clock::now();
+    m_frameTimings.push(currentTime);
+
+    while (m_frameTimings.size() > 60) {
+        m_frameTimings.pop();
+    }
+
+    if (m_frameTimings.size() > 1) {
+        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+            m_frameTimings.back() - m_frameTimings.front()).count();
+        m_currentFps = 1000.0f * (m_frameTimings.size() - 1) / duration;
+    }
+
+    // The overlay only re-uploads glyphs when the formatted text changes
     std::stringstream stats;
     stats << std::fixed << std::setprecision(1)
           << "FPS: " << m_currentFps << "\n"
           << "Input: " << m_config.inputWidth << "x" << m_config.inputHeight << "\n"
           << "Output: " << m_config.outputWidth << "x" << m_config.outputHeight;
+    m_overlay.SetText(stats.str(), 10, 10);
 
-    // Render stats text
-    if (m_statsSurface) {
-        SDL_FreeSurface(m_statsSurface);
+    if (m_currentFrame.image == VK_NULL_HANDLE) {
+        LOG_INFO("Creating current frame buffer");
+        if (!FrameManager::Get().CreateFrame(m_currentFrame, m_config.inputWidth, m_config.inputHeight,
+                                             WindowCapture::kFrameFormat)) {
+            LOG_ERROR("Failed to create current frame");
+            return false;
+        }
     }
-    m_statsSurface = TTF_RenderText_Blended_Wrapped(m_font, stats.str().c_str(), 
-                                                   m_textColor, m_config.outputWidth);
 
-    if (m_statsSurface) {
-        SDL_Rect dstRect = {10, 10, m_statsSurface->w, m_statsSurface->h};
-        SDL_BlitSurface(m_statsSurface, NULL, windowSurface, &dstRect);
+    if (m_config.enableInterpolation && m_previousFrame.image == VK_NULL_HANDLE) {
+        LOG_INFO("Creating previous frame buffer");
+        if (!FrameManager::Get().CreateFrame(m_previousFrame, m_config.inputWidth, m_config.inputHeight,
+                                             WindowCapture::kFrameFormat)) {
+            LOG_ERROR("Failed to create previous frame");
+            return false;
+        }
     }
 
-    if (SDL_MUSTLOCK(windowSurface)) {
-        SDL_UnlockSurface(windowSurface);
+    if (m_outputFrame.image == VK_NULL_HANDLE) {
+        LOG_INFO("Creating output frame buffer");
+        if (!FrameManager::Get().CreateFrame(m_outputFrame, m_config.outputWidth, m_config.outputHeight,
+                                             m_outputFormat)) {
+            LOG_ERROR("Failed to create output frame");
+            return false;
+        }
     }
 
-    // Update the window with the new content
-    if (SDL_UpdateWindowSurface(m_window) != 0) {
-        LOG_ERROR("Failed to update window surface: ", SDL_GetError());
+    if (m_swapchain.IsValid() && m_config.lowLatency) {
+        WaitForPreviousFrame();
     }
 
-    SDL_FreeSurface(surface);
-
-    vkUnmapMemory(VulkanContext::Get().GetDevice(), stagingMemory);
-    FrameManager::Get().DestroyStagingBuffer(stagingBuffer, stagingMemory);
+    if (m_scheduler.NeedsCapture()) {
+        // The last capture becomes the previous frame without a copy
+        if (m_config.enableInterpolation) {
+            std::swap(m_previousFrame, m_currentFrame);
+        }
 
-    if (m_config.enableInterpolation) {
-        if (!FrameManager::Get().CopyFrameData(m_currentFrame, m_previousFrame)) {
-            LOG_ERROR("Failed to store frame for interpolation");
+        int64_t captureTime = FramePacer::Now();
+        LOG_INFO("Attempting to capture frame...");
+        if (!WindowCapture::Get().CaptureFrame(m_currentFrame)) {
+            LOG_ERROR("Failed to capture frame");
             return false;
         }
+        LOG_INFO("Frame captured successfully");
+        m_scheduler.OnCaptured(captureTime);
+        m_motion = nullptr;
+    }
+
+    m_scheduled = m_scheduler.Next();
+    if (m_scheduled.skip) {
+        return true;
+    }
+
+    bool displayed;
+    if (m_swapchain.IsValid()) {
+        displayed = PresentFrame();
+    } else if (m_surfaceImport.IsImported()) {
+        displayed = WriteWindowSurface();
+    } else {
+        displayed = ReadbackFrame();
+    }
+    if (!displayed) {
+        LOG_ERROR("Failed to display frame");
+        return false;
     }
 
     return true;
@@ -627,15 +987,11 @@ void Scaler::Cleanup() {
     // Get Vulkan context once
     auto& vulkan = VulkanContext::Get();
     if (vulkan.GetDevice()) {
+        PipelineCache::Get().WaitForPipelines();
         vkDeviceWaitIdle(vulkan.GetDevice());
     }
 
     // Cleanup TTF/SDL resources
-    if (m_statsSurface) {
-        SDL_FreeSurface(m_statsSurface);
-        m_statsSurface = nullptr;
-    }
-
     if (m_font) {
         TTF_CloseFont(m_font);
         m_font = nullptr;
@@ -643,6 +999,9 @@ void Scaler::Cleanup() {
 
     TTF_Quit();
 
+    // The surface must go before the window it was created for
+    m_swapchain.Destroy();
+
     if (m_window) {
         SDL_DestroyWindow(m_window);
         m_window = nullptr;
@@ -652,9 +1011,28 @@ void Scaler::Cleanup() {
     // Cleanup Vulkan resources
     auto device = vulkan.GetDevice(); // Use the same vulkan reference
 
-    if (m_commandBuffer != VK_NULL_HANDLE) {
-        vkFreeCommandBuffers(device, m_commandPool, 1, &m_commandBuffer);
-        m_commandBuffer = VK_NULL_HANDLE;
+    m_readback.Destroy();
+    m_surfaceImport.Release();
+    m_overlay.Destroy();
+
+    for (auto& slot : m_frameSlots) {
+        if (slot.commandBuffer != VK_NULL_HANDLE) {
+            vkFreeCommandBuffers(device, m_commandPool, 1, &slot.commandBuffer);
+        }
+        if (slot.fence != VK_NULL_HANDLE) {
+            VulkanContext::Get().ReleaseFence(slot.fence);
+            vkDestroyFence(device, slot.fence, nullptr);
+        }
+        if (slot.imageAcquired != VK_NULL_HANDLE) {
+            vkDestroySemaphore(device, slot.imageAcquired, nullptr);
+        }
+        slot = FrameSlot{};
+    }
+    m_frameSlot = 0;
+
+    if (m_queryPool != VK_NULL_HANDLE) {
+        vkDestroyQueryPool(device, m_queryPool, nullptr);
+        m_queryPool = VK_NULL_HANDLE;
     }
 
     if (m_commandPool != VK_NULL_HANDLE) {
@@ -667,30 +1045,13 @@ void Scaler::Cleanup() {
         m_sampler = VK_NULL_HANDLE;
     }
 
-    if (m_scalePipeline != VK_NULL_HANDLE) {
-        vkDestroyPipeline(device, m_scalePipeline, nullptr);
-        m_scalePipeline = VK_NULL_HANDLE;
-    }
+    // Owned by the PipelineCache
+    m_scalePipeline = VK_NULL_HANDLE;
 
-    if (m_scaleShader != VK_NULL_HANDLE) {
-        vkDestroyShaderModule(device, m_scaleShader, nullptr);
-        m_scaleShader = VK_NULL_HANDLE;
-    }
+    m_generatePipeline = VK_NULL_HANDLE;
 
-    if (m_pipelineLayout != VK_NULL_HANDLE) {
-        vkDestroyPipelineLayout(device, m_pipelineLayout, nullptr);
-        m_pipelineLayout = VK_NULL_HANDLE;
-    }
-
-    if (m_descriptorSetLayout != VK_NULL_HANDLE) {
-        vkDestroyDescriptorSetLayout(device, m_descriptorSetLayout, nullptr);
-        m_descriptorSetLayout = VK_NULL_HANDLE;
-    }
-
-    if (m_descriptorPool != VK_NULL_HANDLE) {
-        vkDestroyDescriptorPool(device, m_descriptorPool, nullptr);
-        m_descriptorPool = VK_NULL_HANDLE;
-    }
+    m_scaleBindings.Destroy();
+    m_generateBindings.Destroy();
 
     FrameManager::Get().DestroyFrame(m_currentFrame);
     FrameManager::Get().DestroyFrame(m_previousFrame);
@@ -1,11 +1,15 @@
 #pragma once
 #include <memory>
 #include <queue>
-#include <fstream>
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_ttf.h>  // Add this include
 #include "frame_manager.hpp"
 #include "window_capture.hpp"
+#include "swapchain.hpp"
+#include "readback_ring.hpp"
+#include "surface_import.hpp"
+#include "text_overlay.hpp"
+#include "frame_scheduler.hpp"
 
 struct ScalerConfig {
     uint32_t inputWidth = 0;
@@ -14,12 +18,29 @@ struct ScalerConfig {
     uint32_t outputHeight = 0;
     uint32_t targetFps = 60;
     bool enableInterpolation = true;
-    float interpolationFactor = 0.5f;
+    // Output frames per captured frame; targetFps is the capture rate
+    uint32_t fgMultiplier = 2;
+    FrameGenerationMode fgMode = FrameGenerationMode::Interpolate;
+    // Share of the next source period that extrapolated frames cover
+    float extrapolationFraction = 1.0f;
+    KernelParams kernel;
+    VkPresentModeKHR presentMode = VK_PRESENT_MODE_FIFO_KHR;
+    // Keep at most one frame queued for display and capture only once the
+    // previous one is on screen
+    bool lowLatency = false;
 };
 
 struct ScalePushConstants {
     int32_t inputSize[2];
     int32_t outputSize[2];
+    int32_t overlayBounds[4];
+    int32_t overlayGlyphs;
+};
+
+struct GeneratePushConstants {
+    ScalePushConstants scale;
+    float factor;
+    int32_t blockSize;
 };
 
 class Scaler {
@@ -35,16 +56,49 @@ public:
     bool ProcessFrame();
     bool IsInitialized() const { return m_initialized; }
 
+    // Receives every scaled frame in system memory, a few frames after it
+    // was captured. Must be set before Initialize.
+    void SetReadbackConsumer(ReadbackRing::Consumer consumer) { m_readbackConsumer = std::move(consumer); }
+
+    // Records the scale dispatch with the active kernel parameters; input
+    // must be shader-readable and output in GENERAL layout
+    void RecordScale(VkCommandBuffer commandBuffer, const Frame& input, const Frame& output);
+
 private:
     Scaler() = default;
     ~Scaler() { Cleanup(); }
 
-    bool LoadShaders();
     bool CreateComputePipeline();
-    bool CreateDescriptorPool();
+    // The generate variant warps two source frames by their motion field
+    // and scales the result in one pass
+    VkPipeline GetScalePipeline(bool generate = false);
+    ComputePipelineDesc ScalePipelineDesc(const KernelParams& params, bool generate) const;
     bool CreateFrameResources();
     bool CreateCommandPool();
-    bool ScaleFrame(const Frame& input, Frame& output);
+    bool CreateFrameSlots();
+    // Scales the scheduled frame into the next swapchain image and queues
+    // it for display
+    bool PresentFrame();
+    // Fallback when the window cannot be presented to: scales into the
+    // output frame and queues it on the readback ring
+    bool ReadbackFrame();
+    void OnReadback(const ReadbackView& view);
+    void ShowReadback(const ReadbackView& view);
+    // Software window path without CPU copies: the scaled frame is copied
+    // on the GPU into the imported window surface memory
+    bool SetupSurfaceImport();
+    bool WriteWindowSurface();
+    void WaitForPreviousFrame();
+    // Records the motion search for m_scheduled into the current slot when
+    // it starts a source pair and returns the field to generate the frame
+    // from, or nullptr when the current source frame is shown
+    const MotionField* RecordFrameGeneration(VkCommandBuffer commandBuffer);
+    // Scales the current source frame into output, or with motion generates
+    // the scheduled frame straight at output resolution
+    void RecordOutput(VkCommandBuffer commandBuffer, const MotionField* motion, const Frame& output);
+    void RecordGeneratedScale(VkCommandBuffer commandBuffer, const MotionField& motion, const Frame& output);
+    void EndGpuTime(VkCommandBuffer commandBuffer);
+    void CollectGpuTime(uint32_t slotIndex);
 
     ScalerConfig m_config;
     bool m_initialized = false;
@@ -53,22 +107,48 @@ private:
     Frame m_currentFrame;
     Frame m_previousFrame;
     Frame m_outputFrame;
+
+    // Frame generation
+    FrameScheduler m_scheduler;
+    ScheduledFrame m_scheduled;
+    // Field of the current source pair once searched, shared by all of the
+    // pair's generated frames
+    const MotionField* m_motion = nullptr;
     
     // Vulkan resources
-    VkShaderModule m_scaleShader = VK_NULL_HANDLE;
     VkPipeline m_scalePipeline = VK_NULL_HANDLE;
-    VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
-    VkDescriptorPool m_descriptorPool = VK_NULL_HANDLE;
-    VkDescriptorSetLayout m_descriptorSetLayout = VK_NULL_HANDLE;
-    VkDescriptorSet m_descriptorSet = VK_NULL_HANDLE;
+    VkPipeline m_generatePipeline = VK_NULL_HANDLE;
+    KernelParams m_scaleParams;
+    DescriptorBinder m_scaleBindings;
+    DescriptorBinder m_generateBindings;
     VkCommandPool m_commandPool = VK_NULL_HANDLE;
-    VkCommandBuffer m_commandBuffer = VK_NULL_HANDLE;
     VkSampler m_sampler = VK_NULL_HANDLE;
 
-    // Add these new members
+    // Swapchain presentation
+    struct FrameSlot {
+        VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+        VkFence fence = VK_NULL_HANDLE;
+        VkSemaphore imageAcquired = VK_NULL_HANDLE;
+        // Timestamp queries written and whether the frame was generated
+        bool timed = false;
+        bool generated = false;
+    };
+    static constexpr uint32_t kFramesInFlight = 2;
+    Swapchain m_swapchain;
+    FrameSlot m_frameSlots[kFramesInFlight];
+    uint32_t m_frameSlot = 0;
+    // Two timestamps per frame slot
+    VkQueryPool m_queryPool = VK_NULL_HANDLE;
+
+    // CPU readback, used for display when there is no swapchain
+    ReadbackRing m_readback;
+    ReadbackRing::Consumer m_readbackConsumer;
+    SurfaceImport m_surfaceImport;
+    VkFormat m_outputFormat = VK_FORMAT_R8G8B8A8_UNORM;
+
+    // Stats text, composited by the scale kernel
     TTF_Font* m_font = nullptr;
-    SDL_Surface* m_statsSurface = nullptr;
-    SDL_Color m_textColor = {255, 255, 255, 255};
+    TextOverlay m_overlay;
 
     std::queue<std::chrono::steady_clock::time_point> m_frameTimings;
     float m_currentFps = 0.0f;
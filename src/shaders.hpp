@@ -0,0 +1,72 @@
+#pragma once
+#include <cstdint>
+
+// SPIR-V for the compute shaders, generated by compile_shader() in
+// CMakeLists.txt and embedded into the binary.
+namespace shaders {
+
+inline constexpr uint32_t kScale[] = {
+#include "shaders/scale.comp.inc"
+};
+
+// Writes its output without a format qualifier; needs
+// shaderStorageImageWriteWithoutFormat
+inline constexpr uint32_t kScaleUnformatted[] = {
+#include "shaders/scale_unformatted.comp.inc"
+};
+
+// Generates a frame between or beyond two source frames from their motion
+// field and scales it in the same pass
+inline constexpr uint32_t kScaleGenerate[] = {
+#include "shaders/scale_generate.comp.inc"
+};
+
+inline constexpr uint32_t kScaleGenerateUnformatted[] = {
+#include "shaders/scale_generate_unformatted.comp.inc"
+};
+
+inline constexpr uint32_t kPyramid[] = {
+#include "shaders/pyramid.comp.inc"
+};
+
+inline constexpr uint32_t kScene[] = {
+#include "shaders/scene.comp.inc"
+};
+
+inline constexpr uint32_t kProfile[] = {
+#include "shaders/profile.comp.inc"
+};
+
+inline constexpr uint32_t kGlobal[] = {
+#include "shaders/global.comp.inc"
+};
+
+inline constexpr uint32_t kTiles[] = {
+#include "shaders/tiles.comp.inc"
+};
+
+inline constexpr uint32_t kMotion[] = {
+#include "shaders/motion.comp.inc"
+};
+
+// Sums block differences with subgroup operations; needs compute subgroup
+// arithmetic
+inline constexpr uint32_t kMotionSubgroup[] = {
+#include "shaders/motion_subgroup.comp.inc"
+};
+
+// Inverse search on one patch per block, then blending of the overlapping
+// patch flows into the block field
+inline constexpr uint32_t kDis[] = {
+#include "shaders/dis.comp.inc"
+};
+
+inline constexpr uint32_t kDensify[] = {
+#include "shaders/densify.comp.inc"
+};
+
+inline constexpr uint32_t kInterpolate[] = {
+#include "shaders/interpolate.comp.inc"
+};
+
+} // namespace shaders
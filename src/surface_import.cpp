@@ -0,0 +1,133 @@
+#include "surface_import.hpp"
+#include <bit>
+
+VkFormat SurfaceImport::FormatFor(const SDL_Surface* surface) {
+    switch (surface->format->format) {
+        // Packed little-endian words: B, G, R, A/X in memory
+        case SDL_PIXELFORMAT_ARGB8888:
+        case SDL_PIXELFORMAT_RGB888:
+            return VK_FORMAT_B8G8R8A8_UNORM;
+        case SDL_PIXELFORMAT_ABGR8888:
+        case SDL_PIXELFORMAT_BGR888:
+            return VK_FORMAT_R8G8B8A8_UNORM;
+        default:
+            return VK_FORMAT_UNDEFINED;
+    }
+}
+
+bool SurfaceImport::Matches(const SDL_Surface* surface) const {
+    return IsImported() && surface->pixels == m_pixels &&
+           surface->w == m_width && surface->h == m_height;
+}
+
+bool SurfaceImport::Import(SDL_Surface* surface) {
+    auto& vulkan = VulkanContext::Get();
+    auto device = vulkan.GetDevice();
+
+    Release();
+
+    if (!vulkan.HasExternalMemoryHost()) {
+        return false;
+    }
+
+    VkFormat format = FormatFor(surface);
+    if (format == VK_FORMAT_UNDEFINED) {
+        LOG_INFO("Window surface format ", SDL_GetPixelFormatName(surface->format->format),
+                 " cannot be written by the GPU");
+        return false;
+    }
+
+    // Shared-memory framebuffers are page aligned and page sized; plain heap
+    // allocations usually are not and cannot be imported
+    VkDeviceSize alignment = vulkan.GetHostPointerAlignment();
+    if (reinterpret_cast<uintptr_t>(surface->pixels) % alignment != 0 || surface->pitch % 4 != 0) {
+        LOG_INFO("Window surface memory is not aligned for import");
+        return false;
+    }
+
+    uint32_t memoryTypeBits = 0;
+    if (!vulkan.GetMemoryHostPointerProperties(surface->pixels, memoryTypeBits) || memoryTypeBits == 0) {
+        LOG_INFO("Window surface memory cannot be imported");
+        return false;
+    }
+
+    VkDeviceSize size = static_cast<VkDeviceSize>(surface->pitch) * surface->h;
+    size = (size + alignment - 1) / alignment * alignment;
+
+    VkExternalMemoryBufferCreateInfo externalInfo{};
+    externalInfo.sType = VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_BUFFER_CREATE_INFO;
+    externalInfo.handleTypes = VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT;
+
+    VkBufferCreateInfo bufferInfo{};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.pNext = &externalInfo;
+    bufferInfo.size = size;
+    bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    if (vkCreateBuffer(device, &bufferInfo, nullptr, &m_buffer) != VK_SUCCESS) {
+        LOG_ERROR("Failed to create buffer for window surface");
+        return false;
+    }
+
+    VkMemoryRequirements requirements;
+    vkGetBufferMemoryRequirements(device, m_buffer, &requirements);
+    memoryTypeBits &= requirements.memoryTypeBits;
+    if (memoryTypeBits == 0) {
+        LOG_INFO("No memory type can back both the buffer and the window surface");
+        Release();
+        return false;
+    }
+
+    // The window system reads the pixels without any Vulkan mapping, so
+    // coherent memory is preferred
+    VkPhysicalDeviceMemoryProperties memoryProperties;
+    vkGetPhysicalDeviceMemoryProperties(vulkan.GetPhysicalDevice(), &memoryProperties);
+    uint32_t memoryType = std::countr_zero(memoryTypeBits);
+    for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++) {
+        if ((memoryTypeBits & (1u << i)) &&
+            (memoryProperties.memoryTypes[i].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)) {
+            memoryType = i;
+            break;
+        }
+    }
+
+    VkImportMemoryHostPointerInfoEXT importInfo{};
+    importInfo.sType = VK_STRUCTURE_TYPE_IMPORT_MEMORY_HOST_POINTER_INFO_EXT;
+    importInfo.handleType = VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT;
+    importInfo.pHostPointer = surface->pixels;
+
+    VkMemoryAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.pNext = &importInfo;
+    allocInfo.allocationSize = size;
+    allocInfo.memoryTypeIndex = memoryType;
+
+    if (vkAllocateMemory(device, &allocInfo, nullptr, &m_memory) != VK_SUCCESS ||
+        vkBindBufferMemory(device, m_buffer, m_memory, 0) != VK_SUCCESS) {
+        LOG_WARN("Failed to import window surface memory");
+        Release();
+        return false;
+    }
+
+    m_format = format;
+    m_pixels = surface->pixels;
+    m_rowLength = surface->pitch / 4;
+    m_width = surface->w;
+    m_height = surface->h;
+
+    LOG_INFO("Imported window surface memory (", surface->w, "x", surface->h, ", ",
+             SDL_GetPixelFormatName(surface->format->format), ")");
+    return true;
+}
+
+void SurfaceImport::Release() {
+    auto& vulkan = VulkanContext::Get();
+    if (vulkan.GetDevice()) {
+        vulkan.DestroyBuffer(m_buffer, m_memory);
+    }
+    m_buffer = VK_NULL_HANDLE;
+    m_memory = VK_NULL_HANDLE;
+    m_format = VK_FORMAT_UNDEFINED;
+    m_pixels = nullptr;
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <SDL2/SDL.h>
+#include "vulkan_context.hpp"
+
+// Wraps the pixel memory of an SDL surface in a VkBuffer through
+// VK_EXT_external_memory_host, so a copy on the GPU lands directly in the
+// window without CPU-side conversion or blits. Only possible when the
+// pixels are suitably aligned and stored in a 32-bit layout Vulkan can
+// write.
+class SurfaceImport {
+public:
+    // Vulkan format matching the surface's byte order, or UNDEFINED
+    static VkFormat FormatFor(const SDL_Surface* surface);
+
+    bool Import(SDL_Surface* surface);
+    void Release();
+
+    bool IsImported() const { return m_buffer != VK_NULL_HANDLE; }
+    bool Matches(const SDL_Surface* surface) const;
+
+    VkBuffer GetBuffer() const { return m_buffer; }
+    VkFormat GetFormat() const { return m_format; }
+    // Row pitch of the surface in pixels, for VkBufferImageCopy
+    uint32_t GetRowLength() const { return m_rowLength; }
+
+private:
+    VkBuffer m_buffer = VK_NULL_HANDLE;
+    VkDeviceMemory m_memory = VK_NULL_HANDLE;
+    VkFormat m_format = VK_FORMAT_UNDEFINED;
+    const void* m_pixels = nullptr;
+    uint32_t m_rowLength = 0;
+    int m_width = 0;
+    int m_height = 0;
+};
@@ -0,0 +1,454 @@
+#include "swapchain.hpp"
+#include <algorithm>
+#include <SDL2/SDL_vulkan.h>
+
+namespace {
+
+// Longest a present may stay queued before its completion is no longer tracked
+constexpr uint64_t kPresentWaitTimeoutNs = 1'000'000'000;
+
+const struct {
+    const char* name;
+    VkPresentModeKHR mode;
+} kPresentModes[] = {
+    {"fifo", VK_PRESENT_MODE_FIFO_KHR},
+    {"fifo-relaxed", VK_PRESENT_MODE_FIFO_RELAXED_KHR},
+    {"mailbox", VK_PRESENT_MODE_MAILBOX_KHR},
+    {"immediate", VK_PRESENT_MODE_IMMEDIATE_KHR},
+};
+
+} // namespace
+
+bool ParsePresentMode(const std::string& name, VkPresentModeKHR& mode) {
+    for (const auto& entry : kPresentModes) {
+        if (name == entry.name) {
+            mode = entry.mode;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* PresentModeName(VkPresentModeKHR mode) {
+    for (const auto& entry : kPresentModes) {
+        if (mode == entry.mode) {
+            return entry.name;
+        }
+    }
+    return "unknown";
+}
+
+bool Swapchain::Create(SDL_Window* window, VkPresentModeKHR presentMode, bool lowLatency) {
+    auto& vulkan = VulkanContext::Get();
+
+    if (!vulkan.HasSwapchain()) {
+        LOG_WARN("VK_KHR_swapchain not available");
+        return false;
+    }
+
+    if (!SDL_Vulkan_CreateSurface(window, vulkan.GetInstance(), &m_surface)) {
+        LOG_WARN("Failed to create Vulkan surface: ", SDL_GetError());
+        return false;
+    }
+
+    VkBool32 presentSupported = VK_FALSE;
+    vkGetPhysicalDeviceSurfaceSupportKHR(vulkan.GetPhysicalDevice(), vulkan.GetComputeQueueFamily(),
+                                         m_surface, &presentSupported);
+    if (!presentSupported) {
+        LOG_WARN("Compute queue cannot present to the output window");
+        Destroy();
+        return false;
+    }
+
+    m_window = window;
+    m_requestedPresentMode = presentMode;
+    m_lowLatency = lowLatency;
+    if (!CreateSwapchain()) {
+        Destroy();
+        return false;
+    }
+
+    if (vulkan.HasPresentWait()) {
+        m_stopPresentThread = false;
+        m_presentThread = std::thread(&Swapchain::PresentWaitLoop, this);
+    }
+
+    LOG_INFO("Swapchain created: ", m_extent.width, "x", m_extent.height, ", ",
+             m_images.size(), " images, ", PresentModeName(m_presentMode), ", ",
+             m_supportsStorage ? "direct storage writes" : "blit from output frame");
+    return true;
+}
+
+VkPresentModeKHR Swapchain::ChoosePresentMode(VkPresentModeKHR requested) const {
+    auto physicalDevice = VulkanContext::Get().GetPhysicalDevice();
+
+    uint32_t modeCount = 0;
+    vkGetPhysicalDeviceSurfacePresentModesKHR(physicalDevice, m_surface, &modeCount, nullptr);
+    std::vector<VkPresentModeKHR> modes(modeCount);
+    vkGetPhysicalDeviceSurfacePresentModesKHR(physicalDevice, m_surface, &modeCount, modes.data());
+
+    // Fall back to the mode with the closest tearing/latency trade-off;
+    // FIFO is always available
+    std::vector<VkPresentModeKHR> preferences = {requested};
+    switch (requested) {
+        case VK_PRESENT_MODE_MAILBOX_KHR:
+            preferences.push_back(VK_PRESENT_MODE_IMMEDIATE_KHR);
+            break;
+        case VK_PRESENT_MODE_IMMEDIATE_KHR:
+            preferences.push_back(VK_PRESENT_MODE_MAILBOX_KHR);
+            break;
+        case VK_PRESENT_MODE_FIFO_RELAXED_KHR:
+        default:
+            break;
+    }
+
+    for (auto mode : preferences) {
+        if (std::find(modes.begin(), modes.end(), mode) != modes.end()) {
+            return mode;
+        }
+    }
+    return VK_PRESENT_MODE_FIFO_KHR;
+}
+
+VkSurfaceFormatKHR Swapchain::ChooseSurfaceFormat() const {
+    auto physicalDevice = VulkanContext::Get().GetPhysicalDevice();
+
+    uint32_t formatCount = 0;
+    vkGetPhysicalDeviceSurfaceFormatsKHR(physicalDevice, m_surface, &formatCount, nullptr);
+    std::vector<VkSurfaceFormatKHR> formats(formatCount);
+    vkGetPhysicalDeviceSurfaceFormatsKHR(physicalDevice, m_surface, &formatCount, formats.data());
+
+    // Captured pixels are already gamma encoded, so prefer UNORM formats
+    // that store them unchanged
+    for (const auto& format : formats) {
+        if ((format.format == VK_FORMAT_B8G8R8A8_UNORM || format.format == VK_FORMAT_R8G8B8A8_UNORM) &&
+            format.colorSpace == VK_COLOR_SPACE_SRGB_NONLINEAR_KHR) {
+            return format;
+        }
+    }
+    return formats.empty() ? VkSurfaceFormatKHR{} : formats[0];
+}
+
+bool Swapchain::CreateSwapchain() {
+    auto& vulkan = VulkanContext::Get();
+    auto device = vulkan.GetDevice();
+
+    VkSurfaceCapabilitiesKHR capabilities;
+    if (vkGetPhysicalDeviceSurfaceCapabilitiesKHR(vulkan.GetPhysicalDevice(), m_surface,
+                                                  &capabilities) != VK_SUCCESS) {
+        LOG_ERROR("Failed to query surface capabilities");
+        return false;
+    }
+
+    if (!(capabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_DST_BIT)) {
+        LOG_WARN("Surface does not support transfer writes");
+        return false;
+    }
+
+    VkSurfaceFormatKHR surfaceFormat = ChooseSurfaceFormat();
+    if (surfaceFormat.format == VK_FORMAT_UNDEFINED) {
+        LOG_ERROR("Surface reports no formats");
+        return false;
+    }
+
+    VkExtent2D extent = capabilities.currentExtent;
+    if (extent.width == UINT32_MAX) {
+        int width = 0, height = 0;
+        SDL_Vulkan_GetDrawableSize(m_window, &width, &height);
+        extent.width = std::clamp(static_cast<uint32_t>(width),
+                                  capabilities.minImageExtent.width, capabilities.maxImageExtent.width);
+        extent.height = std::clamp(static_cast<uint32_t>(height),
+                                   capabilities.minImageExtent.height, capabilities.maxImageExtent.height);
+    }
+    if (extent.width == 0 || extent.height == 0) {
+        LOG_WARN("Output window has no drawable area");
+        return false;
+    }
+
+    // One spare image lets the CPU start the next frame while the display
+    // holds the current one; low-latency mode gives that up
+    uint32_t imageCount = m_lowLatency ? capabilities.minImageCount : capabilities.minImageCount + 1;
+    if (capabilities.maxImageCount > 0) {
+        imageCount = std::min(imageCount, capabilities.maxImageCount);
+    }
+
+    VkFormatProperties formatProperties;
+    vkGetPhysicalDeviceFormatProperties(vulkan.GetPhysicalDevice(), surfaceFormat.format, &formatProperties);
+    bool supportsStorage = vulkan.HasStorageWriteWithoutFormat() &&
+        (capabilities.supportedUsageFlags & VK_IMAGE_USAGE_STORAGE_BIT) &&
+        (formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT);
+
+    VkImageUsageFlags usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    if (supportsStorage) {
+        usage |= VK_IMAGE_USAGE_STORAGE_BIT;
+    }
+
+    VkSwapchainCreateInfoKHR createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
+    createInfo.surface = m_surface;
+    createInfo.minImageCount = imageCount;
+    createInfo.imageFormat = surfaceFormat.format;
+    createInfo.imageColorSpace = surfaceFormat.colorSpace;
+    createInfo.imageExtent = extent;
+    createInfo.imageArrayLayers = 1;
+    createInfo.imageUsage = usage;
+    createInfo.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    createInfo.preTransform = capabilities.currentTransform;
+    createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
+    createInfo.presentMode = ChoosePresentMode(m_requestedPresentMode);
+    createInfo.clipped = VK_TRUE;
+    createInfo.oldSwapchain = m_swapchain;
+
+    if (m_swapchain == VK_NULL_HANDLE && createInfo.presentMode != m_requestedPresentMode) {
+        LOG_WARN("Present mode ", PresentModeName(m_requestedPresentMode),
+                 " not supported, using ", PresentModeName(createInfo.presentMode));
+    }
+
+    if (!(capabilities.supportedCompositeAlpha & VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR)) {
+        createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_INHERIT_BIT_KHR;
+    }
+
+    VkSwapchainKHR swapchain = VK_NULL_HANDLE;
+    if (vkCreateSwapchainKHR(device, &createInfo, nullptr, &swapchain) != VK_SUCCESS) {
+        LOG_ERROR("Failed to create swapchain");
+        return false;
+    }
+
+    DestroyImageResources();
+    if (m_swapchain != VK_NULL_HANDLE) {
+        vkDestroySwapchainKHR(device, m_swapchain, nullptr);
+    }
+    m_swapchain = swapchain;
+    m_format = surfaceFormat.format;
+    m_extent = extent;
+    m_supportsStorage = supportsStorage;
+    m_presentMode = createInfo.presentMode;
+
+    uint32_t count = 0;
+    vkGetSwapchainImagesKHR(device, m_swapchain, &count, nullptr);
+    std::vector<VkImage> images(count);
+    vkGetSwapchainImagesKHR(device, m_swapchain, &count, images.data());
+
+    m_images.resize(count);
+    m_renderFinished.resize(count, VK_NULL_HANDLE);
+    for (uint32_t i = 0; i < count; i++) {
+        Frame& frame = m_images[i];
+        frame.image = images[i];
+        frame.width = extent.width;
+        frame.height = extent.height;
+        frame.format = m_format;
+
+        if (m_supportsStorage) {
+            VkImageViewCreateInfo viewInfo{};
+            viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+            viewInfo.image = frame.image;
+            viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+            viewInfo.format = m_format;
+            viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            viewInfo.subresourceRange.levelCount = 1;
+            viewInfo.subresourceRange.layerCount = 1;
+
+            if (vkCreateImageView(device, &viewInfo, nullptr, &frame.view) != VK_SUCCESS) {
+                LOG_ERROR("Failed to create swapchain image view");
+                return false;
+            }
+        }
+
+        VkSemaphoreCreateInfo semaphoreInfo{};
+        semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        if (vkCreateSemaphore(device, &semaphoreInfo, nullptr, &m_renderFinished[i]) != VK_SUCCESS) {
+            LOG_ERROR("Failed to create swapchain semaphore");
+            return false;
+        }
+    }
+
+    m_needsRecreate = false;
+    return true;
+}
+
+bool Swapchain::AcquireNextImage(VkSemaphore signalSemaphore, uint32_t& imageIndex) {
+    auto device = VulkanContext::Get().GetDevice();
+
+    for (int attempt = 0; attempt < 2; attempt++) {
+        if (m_needsRecreate) {
+            // Present ids belong to the old swapchain. Only the one the
+            // waiter may already be waiting on is kept, so it is done with
+            // the old swapchain before that is retired.
+            if (m_presentThread.joinable()) {
+                std::lock_guard<std::mutex> lock(m_presentMutex);
+                if (m_pendingPresents.size() > 1) {
+                    m_pendingPresents.resize(1);
+                }
+            }
+            WaitForQueuedPresents(0);
+            vkDeviceWaitIdle(device);
+            if (!CreateSwapchain()) {
+                return false;
+            }
+            LOG_INFO("Swapchain recreated: ", m_extent.width, "x", m_extent.height);
+        }
+
+        VkResult result = vkAcquireNextImageKHR(device, m_swapchain, UINT64_MAX,
+                                                signalSemaphore, VK_NULL_HANDLE, &imageIndex);
+        if (result == VK_SUCCESS || result == VK_SUBOPTIMAL_KHR) {
+            // Suboptimal images are still presentable; recreate after this frame
+            m_needsRecreate = result == VK_SUBOPTIMAL_KHR;
+            return true;
+        }
+        if (result != VK_ERROR_OUT_OF_DATE_KHR) {
+            LOG_ERROR("Failed to acquire swapchain image: ", result);
+            return false;
+        }
+        m_needsRecreate = true;
+    }
+
+    LOG_ERROR("Swapchain stayed out of date after recreation");
+    return false;
+}
+
+bool Swapchain::Present(uint32_t imageIndex) {
+    VkPresentInfoKHR presentInfo{};
+    presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+    presentInfo.waitSemaphoreCount = 1;
+    presentInfo.pWaitSemaphores = &m_renderFinished[imageIndex];
+    presentInfo.swapchainCount = 1;
+    presentInfo.pSwapchains = &m_swapchain;
+    presentInfo.pImageIndices = &imageIndex;
+
+    VkPresentIdKHR presentId{};
+    presentId.sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR;
+    presentId.swapchainCount = 1;
+    presentId.pPresentIds = &m_nextPresentId;
+
+    bool tracked = m_presentThread.joinable();
+    if (tracked) {
+        presentInfo.pNext = &presentId;
+    }
+
+    auto queued = std::chrono::steady_clock::now();
+    VkResult result = vkQueuePresentKHR(VulkanContext::Get().GetComputeQueue(), &presentInfo);
+    if (tracked) {
+        // Only ids that reached the presentation engine ever complete; any
+        // other would hold the waiter for its full timeout
+        if (result == VK_SUCCESS || result == VK_SUBOPTIMAL_KHR) {
+            std::lock_guard<std::mutex> lock(m_presentMutex);
+            m_pendingPresents.push_back({m_nextPresentId, queued});
+        }
+        m_nextPresentId++;
+        m_presentCondition.notify_all();
+    }
+    if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR) {
+        m_needsRecreate = true;
+        return true;
+    }
+    if (result != VK_SUCCESS) {
+        LOG_ERROR("Failed to present swapchain image: ", result);
+        return false;
+    }
+    return true;
+}
+
+void Swapchain::PresentWaitLoop() {
+    auto& vulkan = VulkanContext::Get();
+    std::unique_lock<std::mutex> lock(m_presentMutex);
+
+    while (true) {
+        m_presentCondition.wait(lock, [this] {
+            return m_stopPresentThread || !m_pendingPresents.empty();
+        });
+        if (m_pendingPresents.empty()) {
+            return;
+        }
+
+        PendingPresent pending = m_pendingPresents.front();
+        VkSwapchainKHR swapchain = m_swapchain;
+        lock.unlock();
+
+        VkResult result = vulkan.WaitForPresent(swapchain, pending.id, kPresentWaitTimeoutNs);
+        auto presented = std::chrono::steady_clock::now();
+
+        lock.lock();
+        m_pendingPresents.pop_front();
+        if (result == VK_SUCCESS) {
+            double delayMs = std::chrono::duration<double, std::milli>(presented - pending.queued).count();
+            m_delayMinMs = m_delayCount == 0 ? delayMs : std::min(m_delayMinMs, delayMs);
+            m_delayMaxMs = m_delayCount == 0 ? delayMs : std::max(m_delayMaxMs, delayMs);
+            m_delaySumMs += delayMs;
+            m_delayCount++;
+        }
+        m_presentCondition.notify_all();
+    }
+}
+
+bool Swapchain::WaitForQueuedPresents(uint32_t maxQueued) {
+    if (!m_presentThread.joinable()) {
+        return false;
+    }
+
+    std::unique_lock<std::mutex> lock(m_presentMutex);
+    m_presentCondition.wait(lock, [this, maxQueued] {
+        return m_pendingPresents.size() <= maxQueued;
+    });
+    return true;
+}
+
+bool Swapchain::TakePresentDelay(PresentDelayStats& stats) {
+    std::lock_guard<std::mutex> lock(m_presentMutex);
+    if (m_delayCount == 0) {
+        return false;
+    }
+
+    stats.count = m_delayCount;
+    stats.averageMs = m_delaySumMs / m_delayCount;
+    stats.minMs = m_delayMinMs;
+    stats.maxMs = m_delayMaxMs;
+
+    m_delayCount = 0;
+    m_delaySumMs = 0.0;
+    return true;
+}
+
+void Swapchain::DestroyImageResources() {
+    auto device = VulkanContext::Get().GetDevice();
+
+    for (auto& frame : m_images) {
+        if (frame.view != VK_NULL_HANDLE) {
+            vkDestroyImageView(device, frame.view, nullptr);
+        }
+    }
+    m_images.clear();
+
+    for (auto semaphore : m_renderFinished) {
+        if (semaphore != VK_NULL_HANDLE) {
+            vkDestroySemaphore(device, semaphore, nullptr);
+        }
+    }
+    m_renderFinished.clear();
+}
+
+void Swapchain::Destroy() {
+    auto& vulkan = VulkanContext::Get();
+
+    if (m_presentThread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(m_presentMutex);
+            m_stopPresentThread = true;
+        }
+        m_presentCondition.notify_all();
+        m_presentThread.join();
+    }
+
+    if (vulkan.GetDevice()) {
+        DestroyImageResources();
+        if (m_swapchain != VK_NULL_HANDLE) {
+            vkDestroySwapchainKHR(vulkan.GetDevice(), m_swapchain, nullptr);
+        }
+    }
+    m_swapchain = VK_NULL_HANDLE;
+
+    if (m_surface != VK_NULL_HANDLE && vulkan.GetInstance()) {
+        vkDestroySurfaceKHR(vulkan.GetInstance(), m_surface, nullptr);
+    }
+    m_surface = VK_NULL_HANDLE;
+    m_window = nullptr;
+}
@@ -0,0 +1,96 @@
+#pragma once
+#include <vulkan/vulkan.hpp>
+#include <vector>
+#include <deque>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <string>
+#include <SDL2/SDL.h>
+#include "frame_manager.hpp"
+
+bool ParsePresentMode(const std::string& name, VkPresentModeKHR& mode);
+const char* PresentModeName(VkPresentModeKHR mode);
+
+// Time from vkQueuePresentKHR until the image reached the display, over
+// the presents completed since the last query
+struct PresentDelayStats {
+    uint32_t count = 0;
+    double averageMs = 0.0;
+    double minMs = 0.0;
+    double maxMs = 0.0;
+};
+
+// Presents frames to an SDL window through VK_KHR_swapchain. When the
+// surface allows storage usage, swapchain images get views so the scale
+// kernel can write into them directly; otherwise they are blit targets.
+class Swapchain {
+public:
+    // presentMode falls back to the closest supported mode. lowLatency
+    // uses the smallest image count the surface allows.
+    bool Create(SDL_Window* window, VkPresentModeKHR presentMode, bool lowLatency);
+    void Destroy();
+
+    // Acquires the next image, recreating the swapchain first if the last
+    // present reported it out of date. signalSemaphore is signalled once
+    // the image is ready to be written.
+    bool AcquireNextImage(VkSemaphore signalSemaphore, uint32_t& imageIndex);
+    // Queues imageIndex for presentation after GetRenderFinished(imageIndex)
+    // is signalled
+    bool Present(uint32_t imageIndex);
+
+    // Blocks until at most maxQueued presents are still waiting for the
+    // display. Returns false if present completion cannot be observed.
+    bool WaitForQueuedPresents(uint32_t maxQueued);
+    bool TakePresentDelay(PresentDelayStats& stats);
+
+    bool IsValid() const { return m_swapchain != VK_NULL_HANDLE; }
+    VkPresentModeKHR GetPresentMode() const { return m_presentMode; }
+    bool SupportsStorage() const { return m_supportsStorage; }
+    const Frame& GetImage(uint32_t imageIndex) const { return m_images[imageIndex]; }
+    VkSemaphore GetRenderFinished(uint32_t imageIndex) const { return m_renderFinished[imageIndex]; }
+    VkExtent2D GetExtent() const { return m_extent; }
+
+private:
+    bool CreateSwapchain();
+    void DestroyImageResources();
+    VkSurfaceFormatKHR ChooseSurfaceFormat() const;
+    VkPresentModeKHR ChoosePresentMode(VkPresentModeKHR requested) const;
+    void PresentWaitLoop();
+
+    SDL_Window* m_window = nullptr;
+    VkSurfaceKHR m_surface = VK_NULL_HANDLE;
+    VkSwapchainKHR m_swapchain = VK_NULL_HANDLE;
+    VkFormat m_format = VK_FORMAT_UNDEFINED;
+    VkExtent2D m_extent{};
+    bool m_supportsStorage = false;
+    bool m_needsRecreate = false;
+    VkPresentModeKHR m_requestedPresentMode = VK_PRESENT_MODE_FIFO_KHR;
+    VkPresentModeKHR m_presentMode = VK_PRESENT_MODE_FIFO_KHR;
+    bool m_lowLatency = false;
+
+    // Wrapped as frames so recording code can treat them like any other
+    // image; memory is owned by the swapchain
+    std::vector<Frame> m_images;
+    // One per image: a present may still be waiting on it when the slot
+    // that signalled it comes round again
+    std::vector<VkSemaphore> m_renderFinished;
+
+    // Present ids still waiting for the display, drained by a thread
+    // blocked in vkWaitForPresentKHR
+    struct PendingPresent {
+        uint64_t id;
+        std::chrono::steady_clock::time_point queued;
+    };
+    std::thread m_presentThread;
+    std::mutex m_presentMutex;
+    std::condition_variable m_presentCondition;
+    std::deque<PendingPresent> m_pendingPresents;
+    bool m_stopPresentThread = false;
+    uint64_t m_nextPresentId = 1;
+    uint32_t m_delayCount = 0;
+    double m_delaySumMs = 0.0;
+    double m_delayMinMs = 0.0;
+    double m_delayMaxMs = 0.0;
+};
@@ -0,0 +1,209 @@
+#include "text_overlay.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+constexpr int32_t kAtlasWidth = 512;
+// Space around the text that the darkened backing extends over
+constexpr int32_t kPadding = 4;
+
+} // namespace
+
+bool TextOverlay::Create(TTF_Font* font, uint32_t slots) {
+    auto& vulkan = VulkanContext::Get();
+
+    if (!BuildAtlas(font)) {
+        return false;
+    }
+
+    m_slotCount = std::min(slots, kMaxSlots);
+    for (uint32_t i = 0; i < m_slotCount; i++) {
+        Slot& slot = m_slots[i];
+        VkDeviceSize size = kMaxGlyphs * sizeof(OverlayGlyph);
+        if (!vulkan.CreateBuffer(size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                 slot.buffer, slot.memory)) {
+            LOG_ERROR("Failed to create overlay glyph buffer");
+            return false;
+        }
+        if (vkMapMemory(vulkan.GetDevice(), slot.memory, 0, VK_WHOLE_SIZE, 0, &slot.mapped) != VK_SUCCESS) {
+            LOG_ERROR("Failed to map overlay glyph buffer");
+            return false;
+        }
+        slot.version = 0;
+    }
+
+    return true;
+}
+
+bool TextOverlay::BuildAtlas(TTF_Font* font) {
+    const SDL_Color white = {255, 255, 255, 255};
+    std::vector<SDL_Surface*> surfaces;
+
+    // Shelf-pack the glyphs into rows of kAtlasWidth
+    int32_t x = 0, y = 0, rowHeight = 0;
+    for (char c = kFirstChar; c <= kLastChar; c++) {
+        GlyphInfo& info = m_glyphInfo[c - kFirstChar];
+
+        int minX, maxX, minY, maxY, advance;
+        if (TTF_GlyphMetrics(font, c, &minX, &maxX, &minY, &maxY, &advance) == 0) {
+            info.advance = advance;
+        }
+
+        SDL_Surface* converted = nullptr;
+        if (SDL_Surface* glyph = TTF_RenderGlyph_Blended(font, c, white)) {
+            converted = SDL_ConvertSurfaceFormat(glyph, SDL_PIXELFORMAT_ARGB8888, 0);
+            SDL_FreeSurface(glyph);
+        }
+        surfaces.push_back(converted);
+        if (!converted) {
+            continue;
+        }
+
+        if (x + converted->w > kAtlasWidth) {
+            x = 0;
+            y += rowHeight + 1;
+            rowHeight = 0;
+        }
+        info.atlasX = x;
+        info.atlasY = y;
+        info.width = converted->w;
+        info.height = converted->h;
+        x += converted->w + 1;
+        rowHeight = std::max(rowHeight, converted->h);
+    }
+    m_lineSkip = TTF_FontLineSkip(font);
+
+    // Only coverage is needed; white text is applied in the shader
+    int32_t atlasHeight = std::max(y + rowHeight, 1);
+    std::vector<uint8_t> pixels(kAtlasWidth * atlasHeight, 0);
+    for (size_t i = 0; i < surfaces.size(); i++) {
+        SDL_Surface* surface = surfaces[i];
+        if (!surface) {
+            continue;
+        }
+
+        const GlyphInfo& info = m_glyphInfo[i];
+        SDL_LockSurface(surface);
+        for (int row = 0; row < surface->h; row++) {
+            auto* src = reinterpret_cast<const uint32_t*>(
+                static_cast<const uint8_t*>(surface->pixels) + row * surface->pitch);
+            uint8_t* dst = &pixels[(info.atlasY + row) * kAtlasWidth + info.atlasX];
+            for (int col = 0; col < surface->w; col++) {
+                dst[col] = static_cast<uint8_t>(src[col] >> 24);
+            }
+        }
+        SDL_UnlockSurface(surface);
+        SDL_FreeSurface(surface);
+    }
+
+    auto& frameManager = FrameManager::Get();
+    if (!frameManager.CreateFrame(m_atlas, kAtlasWidth, atlasHeight, VK_FORMAT_R8_UNORM)) {
+        LOG_ERROR("Failed to create overlay atlas");
+        return false;
+    }
+
+    VkBuffer stagingBuffer;
+    VkDeviceMemory stagingMemory;
+    if (!frameManager.CreateStagingBuffer(stagingBuffer, stagingMemory, pixels.size())) {
+        LOG_ERROR("Failed to create overlay staging buffer");
+        return false;
+    }
+
+    auto device = VulkanContext::Get().GetDevice();
+    void* mapped;
+    vkMapMemory(device, stagingMemory, 0, pixels.size(), 0, &mapped);
+    memcpy(mapped, pixels.data(), pixels.size());
+    vkUnmapMemory(device, stagingMemory);
+
+    VkCommandBuffer commandBuffer = frameManager.BeginSingleTimeCommands();
+    frameManager.TransitionImage(commandBuffer, m_atlas.image,
+        VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        0, VK_ACCESS_TRANSFER_WRITE_BIT,
+        VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+    VkBufferImageCopy region{};
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.layerCount = 1;
+    region.imageExtent = {m_atlas.width, m_atlas.height, 1};
+    vkCmdCopyBufferToImage(commandBuffer, stagingBuffer, m_atlas.image,
+                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+    frameManager.TransitionImage(commandBuffer, m_atlas.image,
+        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+        VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+        VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+    frameManager.EndSingleTimeCommands(commandBuffer);
+    frameManager.DestroyStagingBuffer(stagingBuffer, stagingMemory);
+
+    LOG_INFO("Overlay glyph atlas: ", m_atlas.width, "x", m_atlas.height);
+    return true;
+}
+
+void TextOverlay::SetText(const std::string& text, int32_t x, int32_t y) {
+    if (text == m_text && m_bounds[0] == x - kPadding && m_bounds[1] == y - kPadding) {
+        return;
+    }
+    m_text = text;
+    m_glyphs.clear();
+
+    int32_t penX = x, penY = y;
+    int32_t right = x, bottom = y;
+    for (char c : text) {
+        if (c == '\n') {
+            penX = x;
+            penY += m_lineSkip;
+            continue;
+        }
+        if (c < kFirstChar || c > kLastChar) {
+            continue;
+        }
+
+        const GlyphInfo& info = m_glyphInfo[c - kFirstChar];
+        if (info.width > 0 && m_glyphs.size() < kMaxGlyphs) {
+            m_glyphs.push_back({
+                .dst = {penX, penY, info.width, info.height},
+                .src = {info.atlasX, info.atlasY, 0, 0}
+            });
+            right = std::max(right, penX + info.width);
+            bottom = std::max(bottom, penY + info.height);
+        }
+        penX += info.advance;
+    }
+
+    m_bounds[0] = x - kPadding;
+    m_bounds[1] = y - kPadding;
+    m_bounds[2] = right + kPadding;
+    m_bounds[3] = bottom + kPadding;
+    m_version++;
+}
+
+void TextOverlay::Update(uint32_t slot) {
+    Slot& target = m_slots[slot];
+    if (target.version == m_version || !target.mapped) {
+        return;
+    }
+    memcpy(target.mapped, m_glyphs.data(), m_glyphs.size() * sizeof(OverlayGlyph));
+    target.version = m_version;
+}
+
+void TextOverlay::Destroy() {
+    auto& vulkan = VulkanContext::Get();
+    if (!vulkan.GetDevice()) {
+        return;
+    }
+
+    for (auto& slot : m_slots) {
+        if (slot.mapped) {
+            vkUnmapMemory(vulkan.GetDevice(), slot.memory);
+        }
+        vulkan.DestroyBuffer(slot.buffer, slot.memory);
+        slot = Slot{};
+    }
+    m_slotCount = 0;
+
+    FrameManager::Get().DestroyFrame(m_atlas);
+    m_glyphs.clear();
+    m_text.clear();
+}
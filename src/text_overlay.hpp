@@ -0,0 +1,72 @@
+#pragma once
+#include <array>
+#include <string>
+#include <vector>
+#include <SDL2/SDL_ttf.h>
+#include "frame_manager.hpp"
+
+// Matches struct OverlayGlyph in shaders/overlay.glsl (std430)
+struct OverlayGlyph {
+    int32_t dst[4];
+    int32_t src[4];
+};
+
+// Stats text drawn by the scale kernel. Printable ASCII is rasterised once
+// into a coverage atlas; each frame only needs a small buffer of glyph
+// instances, which is rebuilt when the text changes.
+class TextOverlay {
+public:
+    static constexpr uint32_t kMaxGlyphs = 256;
+    static constexpr uint32_t kMaxSlots = 2;
+
+    // slots is the number of frames that may read glyph buffers at once
+    bool Create(TTF_Font* font, uint32_t slots);
+    void Destroy();
+
+    // Lays text out with its top-left corner at (x, y)
+    void SetText(const std::string& text, int32_t x, int32_t y);
+    // Brings slot's glyph buffer up to date. The caller must have waited for
+    // the previous frame that used slot.
+    void Update(uint32_t slot);
+
+    VkImageView GetAtlasView() const { return m_atlas.view; }
+    VkBuffer GetGlyphBuffer(uint32_t slot) const { return m_slots[slot].buffer; }
+    uint32_t GetGlyphCount() const { return static_cast<uint32_t>(m_glyphs.size()); }
+    // x0, y0, x1, y1 of the laid out text
+    const int32_t* GetBounds() const { return m_bounds; }
+
+private:
+    struct GlyphInfo {
+        int32_t atlasX = 0;
+        int32_t atlasY = 0;
+        int32_t width = 0;
+        int32_t height = 0;
+        int32_t advance = 0;
+    };
+
+    struct Slot {
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        void* mapped = nullptr;
+        uint64_t version = 0;
+    };
+
+    bool BuildAtlas(TTF_Font* font);
+
+    static constexpr char kFirstChar = ' ';
+    static constexpr char kLastChar = '~';
+
+    Frame m_atlas;
+    std::array<GlyphInfo, kLastChar - kFirstChar + 1> m_glyphInfo{};
+    int32_t m_lineSkip = 0;
+
+    std::array<Slot, kMaxSlots> m_slots{};
+    uint32_t m_slotCount = 0;
+
+    std::string m_text;
+    std::vector<OverlayGlyph> m_glyphs;
+    int32_t m_bounds[4] = {};
+    // Bumped whenever m_glyphs changes; slots holding an older version
+    // are rewritten before use
+    uint64_t m_version = 1;
+};
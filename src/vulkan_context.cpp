@@ -1,4 +1,6 @@
 #include "vulkan_context.hpp"
+#include <algorithm>
+#include <cstring>
 
 bool VulkanContext::Initialize() {
     LOG_INFO("Initializing Vulkan context");
@@ -23,10 +25,14 @@ bool VulkanContext::Initialize() {
 }
 
 void VulkanContext::Cleanup() {
+    m_inFlight.clear();
     if (m_device) {
         vkDestroyDevice(m_device, nullptr);
         m_device = VK_NULL_HANDLE;
     }
+
+    m_hasPushDescriptors = false;
+    m_cmdPushDescriptorSetWithTemplate = nullptr;
     
     if (m_instance) {
         vkDestroyInstance(m_instance, nullptr);
@@ -52,10 +58,23 @@ bool VulkanContext::CreateInstance() {
     createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
     createInfo.pApplicationInfo = &appInfo;
 
-    std::vector<const char*> extensions = {
-        VK_KHR_SURFACE_EXTENSION_NAME,
-        VK_KHR_XCB_SURFACE_EXTENSION_NAME
-    };
+    uint32_t extensionCount = 0;
+    vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, nullptr);
+    std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+    vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, availableExtensions.data());
+
+    // Enable every window-system surface the loader offers so SDL can create
+    // a presentable surface regardless of the video driver it picked
+    std::vector<const char*> extensions;
+    if (IsExtensionSupported(availableExtensions, VK_KHR_SURFACE_EXTENSION_NAME)) {
+        extensions.push_back(VK_KHR_SURFACE_EXTENSION_NAME);
+        m_hasSurface = true;
+        for (const char* name : {"VK_KHR_xcb_surface", "VK_KHR_xlib_surface", "VK_KHR_wayland_surface"}) {
+            if (IsExtensionSupported(availableExtensions, name)) {
+                extensions.push_back(name);
+            }
+        }
+    }
 
     createInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
     createInfo.ppEnabledExtensionNames = extensions.data();
@@ -91,20 +110,27 @@ bool VulkanContext::SelectPhysicalDevice() {
 
         if (deviceProperties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU) {
             m_physicalDevice = device;
-            LOG_INFO("Selected GPU: ", deviceProperties.deviceName);
-            return true;
+            break;
         }
     }
 
-    if (devices.size() > 0) {
+    if (m_physicalDevice == VK_NULL_HANDLE) {
         m_physicalDevice = devices[0];
-        VkPhysicalDeviceProperties deviceProperties;
-        vkGetPhysicalDeviceProperties(m_physicalDevice, &deviceProperties);
-        LOG_INFO("Selected GPU: ", deviceProperties.deviceName);
-        return true;
     }
 
-    return false;
+    VkPhysicalDeviceIDProperties idProperties{};
+    idProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES;
+
+    VkPhysicalDeviceProperties2 properties2{};
+    properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    properties2.pNext = &idProperties;
+
+    vkGetPhysicalDeviceProperties2(m_physicalDevice, &properties2);
+    m_deviceProperties = properties2.properties;
+    memcpy(m_deviceUUID, idProperties.deviceUUID, VK_UUID_SIZE);
+
+    LOG_INFO("Selected GPU: ", m_deviceProperties.deviceName);
+    return true;
 }
 
 bool VulkanContext::CreateLogicalDevice() {
@@ -126,6 +152,7 @@ bool VulkanContext::CreateLogicalDevice() {
         LOG_ERROR("No compute queue family found");
         return false;
     }
+    m_timestampValidBits = queueFamilies[m_computeQueueFamily].timestampValidBits;
 
     float queuePriority = 1.0f;
     VkDeviceQueueCreateInfo queueCreateInfo{};
@@ -134,14 +161,95 @@ bool VulkanContext::CreateLogicalDevice() {
     queueCreateInfo.queueCount = 1;
     queueCreateInfo.pQueuePriorities = &queuePriority;
 
+    VkPhysicalDeviceFeatures supportedFeatures{};
+    vkGetPhysicalDeviceFeatures(m_physicalDevice, &supportedFeatures);
+
+    // Lets the scale kernel store straight into swapchain images whatever
+    // their channel order
     VkPhysicalDeviceFeatures deviceFeatures{};
+    deviceFeatures.shaderStorageImageWriteWithoutFormat = supportedFeatures.shaderStorageImageWriteWithoutFormat;
+    m_hasStorageWriteWithoutFormat = supportedFeatures.shaderStorageImageWriteWithoutFormat == VK_TRUE;
+
+    uint32_t extensionCount = 0;
+    vkEnumerateDeviceExtensionProperties(m_physicalDevice, nullptr, &extensionCount, nullptr);
+    std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+    vkEnumerateDeviceExtensionProperties(m_physicalDevice, nullptr, &extensionCount,
+                                         availableExtensions.data());
+
+    std::vector<const char*> extensions;
+    if (IsExtensionSupported(availableExtensions, VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME)) {
+        extensions.push_back(VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME);
+        m_hasPushDescriptors = true;
+    }
+    if (m_hasSurface && IsExtensionSupported(availableExtensions, VK_KHR_SWAPCHAIN_EXTENSION_NAME)) {
+        extensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+        m_hasSwapchain = true;
+    }
+
+    // Present wait lets the presenter see when each frame reached the display
+    VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures{};
+    presentWaitFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+    VkPhysicalDevicePresentIdFeaturesKHR presentIdFeatures{};
+    presentIdFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+    presentIdFeatures.pNext = &presentWaitFeatures;
+
+    if (m_hasSwapchain && m_deviceProperties.apiVersion >= VK_API_VERSION_1_1 &&
+        IsExtensionSupported(availableExtensions, VK_KHR_PRESENT_ID_EXTENSION_NAME) &&
+        IsExtensionSupported(availableExtensions, VK_KHR_PRESENT_WAIT_EXTENSION_NAME)) {
+        VkPhysicalDeviceFeatures2 features2{};
+        features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        features2.pNext = &presentIdFeatures;
+        vkGetPhysicalDeviceFeatures2(m_physicalDevice, &features2);
+
+        if (presentIdFeatures.presentId && presentWaitFeatures.presentWait) {
+            extensions.push_back(VK_KHR_PRESENT_ID_EXTENSION_NAME);
+            extensions.push_back(VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+            m_hasPresentWait = true;
+        }
+    }
+
+    // Host pointer import lets the GPU write straight into CPU-owned pixel
+    // memory such as an SDL window surface
+    if (m_deviceProperties.apiVersion >= VK_API_VERSION_1_1 &&
+        IsExtensionSupported(availableExtensions, VK_EXT_EXTERNAL_MEMORY_HOST_EXTENSION_NAME)) {
+        VkPhysicalDeviceExternalMemoryHostPropertiesEXT hostProperties{};
+        hostProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTERNAL_MEMORY_HOST_PROPERTIES_EXT;
+        VkPhysicalDeviceProperties2 properties2{};
+        properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+        properties2.pNext = &hostProperties;
+        vkGetPhysicalDeviceProperties2(m_physicalDevice, &properties2);
+
+        extensions.push_back(VK_EXT_EXTERNAL_MEMORY_HOST_EXTENSION_NAME);
+        m_hostPointerAlignment = hostProperties.minImportedHostPointerAlignment;
+        m_hasExternalMemoryHost = true;
+    }
+
+    // Subgroup reductions let kernels sum across invocations without
+    // shared memory round trips
+    if (m_deviceProperties.apiVersion >= VK_API_VERSION_1_1) {
+        VkPhysicalDeviceSubgroupProperties subgroupProperties{};
+        subgroupProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_PROPERTIES;
+        VkPhysicalDeviceProperties2 properties2{};
+        properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+        properties2.pNext = &subgroupProperties;
+        vkGetPhysicalDeviceProperties2(m_physicalDevice, &properties2);
+
+        m_hasSubgroupArithmetic =
+            (subgroupProperties.supportedStages & VK_SHADER_STAGE_COMPUTE_BIT) &&
+            (subgroupProperties.supportedOperations & VK_SUBGROUP_FEATURE_ARITHMETIC_BIT);
+        m_subgroupSize = std::max(subgroupProperties.subgroupSize, 1u);
+    }
 
     VkDeviceCreateInfo createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
     createInfo.queueCreateInfoCount = 1;
     createInfo.pQueueCreateInfos = &queueCreateInfo;
     createInfo.pEnabledFeatures = &deviceFeatures;
-    createInfo.enabledExtensionCount = 0;
+    if (m_hasPresentWait) {
+        createInfo.pNext = &presentIdFeatures;
+    }
+    createInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
+    createInfo.ppEnabledExtensionNames = extensions.data();
 
     if (vkCreateDevice(m_physicalDevice, &createInfo, nullptr, &m_device) != VK_SUCCESS) {
         LOG_ERROR("Failed to create logical device");
@@ -149,9 +257,96 @@ bool VulkanContext::CreateLogicalDevice() {
     }
 
     vkGetDeviceQueue(m_device, m_computeQueueFamily, 0, &m_computeQueue);
+
+    if (m_hasPushDescriptors) {
+        m_cmdPushDescriptorSetWithTemplate = reinterpret_cast<PFN_vkCmdPushDescriptorSetWithTemplateKHR>(
+            vkGetDeviceProcAddr(m_device, "vkCmdPushDescriptorSetWithTemplateKHR"));
+        m_hasPushDescriptors = m_cmdPushDescriptorSetWithTemplate != nullptr;
+    }
+
+    if (m_hasPresentWait) {
+        m_waitForPresent = reinterpret_cast<PFN_vkWaitForPresentKHR>(
+            vkGetDeviceProcAddr(m_device, "vkWaitForPresentKHR"));
+        m_hasPresentWait = m_waitForPresent != nullptr;
+    }
+
+    if (m_hasExternalMemoryHost) {
+        m_getMemoryHostPointerProperties = reinterpret_cast<PFN_vkGetMemoryHostPointerPropertiesEXT>(
+            vkGetDeviceProcAddr(m_device, "vkGetMemoryHostPointerPropertiesEXT"));
+        m_hasExternalMemoryHost = m_getMemoryHostPointerProperties != nullptr;
+    }
+
+    LOG_INFO("Push descriptors: ", m_hasPushDescriptors ? "enabled" : "unavailable, using update templates");
+    LOG_INFO("Present wait: ", m_hasPresentWait ? "enabled" : "unavailable");
+    return true;
+}
+
+bool VulkanContext::IsExtensionSupported(const std::vector<VkExtensionProperties>& available,
+                                         const char* name) const {
+    for (const auto& extension : available) {
+        if (strcmp(extension.extensionName, name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void VulkanContext::CmdPushDescriptorSetWithTemplate(VkCommandBuffer commandBuffer,
+                                                     VkDescriptorUpdateTemplate updateTemplate,
+                                                     VkPipelineLayout layout, uint32_t set,
+                                                     const void* data) const {
+    m_cmdPushDescriptorSetWithTemplate(commandBuffer, updateTemplate, layout, set, data);
+}
+
+VkResult VulkanContext::WaitForPresent(VkSwapchainKHR swapchain, uint64_t presentId,
+                                       uint64_t timeout) const {
+    return m_waitForPresent(m_device, swapchain, presentId, timeout);
+}
+
+bool VulkanContext::GetMemoryHostPointerProperties(const void* pointer, uint32_t& memoryTypeBits) const {
+    VkMemoryHostPointerPropertiesEXT properties{};
+    properties.sType = VK_STRUCTURE_TYPE_MEMORY_HOST_POINTER_PROPERTIES_EXT;
+    if (m_getMemoryHostPointerProperties(m_device, VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT,
+                                         pointer, &properties) != VK_SUCCESS) {
+        return false;
+    }
+    memoryTypeBits = properties.memoryTypeBits;
     return true;
 }
 
+double VulkanContext::TimestampIntervalMs(uint64_t begin, uint64_t end) const {
+    uint64_t mask = m_timestampValidBits >= 64 ? ~0ull : (1ull << m_timestampValidBits) - 1;
+    uint64_t ticks = (end - begin) & mask;
+    return ticks * static_cast<double>(m_deviceProperties.limits.timestampPeriod) / 1e6;
+}
+
+VkResult VulkanContext::Submit(const VkSubmitInfo& submitInfo, VkFence fence) {
+    VkResult result = vkQueueSubmit(m_computeQueue, 1, &submitInfo, fence);
+    if (result != VK_SUCCESS) {
+        return result;
+    }
+
+    // Owners wait for a fence before resetting and reusing it, so earlier
+    // submissions it tracked are complete even though it reads unsignaled
+    ReleaseFence(fence);
+    m_inFlight.push_back({++m_submittedSerial, fence});
+    return VK_SUCCESS;
+}
+
+uint64_t VulkanContext::GetCompletedSerial() {
+    while (!m_inFlight.empty() &&
+           vkGetFenceStatus(m_device, m_inFlight.front().fence) == VK_SUCCESS) {
+        m_inFlight.pop_front();
+    }
+    return m_inFlight.empty() ? m_submittedSerial : m_inFlight.front().serial - 1;
+}
+
+void VulkanContext::ReleaseFence(VkFence fence) {
+    std::erase_if(m_inFlight, [fence](const Submission& submission) {
+        return submission.fence == fence;
+    });
+}
+
 bool VulkanContext::CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage,
                                VkMemoryPropertyFlags properties,
                                VkBuffer& buffer, VkDeviceMemory& bufferMemory) {
@@ -192,7 +387,7 @@ bool VulkanContext::CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage,
 
 bool VulkanContext::CreateImage(uint32_t width, uint32_t height, VkFormat format,
                               VkImageUsageFlags usage, VkMemoryPropertyFlags properties,
-                              VkImage& image, VkDeviceMemory& imageMemory) {
+                              VkImage& image, VkDeviceMemory& imageMemory, uint32_t layers) {
     VkImageCreateInfo imageInfo{};
     imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
     imageInfo.imageType = VK_IMAGE_TYPE_2D;
@@ -200,7 +395,7 @@ bool VulkanContext::CreateImage(uint32_t width, uint32_t height, VkFormat format
     imageInfo.extent.height = height;
     imageInfo.extent.depth = 1;
     imageInfo.mipLevels = 1;
-    imageInfo.arrayLayers = 1;
+    imageInfo.arrayLayers = layers;
     imageInfo.format = format;
     imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
     imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
@@ -255,6 +450,18 @@ void VulkanContext::DestroyImage(VkImage image, VkDeviceMemory memory) {
     }
 }
 
+bool VulkanContext::SupportsMemoryProperties(VkMemoryPropertyFlags properties) const {
+    VkPhysicalDeviceMemoryProperties memProperties;
+    vkGetPhysicalDeviceMemoryProperties(m_physicalDevice, &memProperties);
+
+    for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) {
+        if ((memProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+            return true;
+        }
+    }
+    return false;
+}
+
 uint32_t VulkanContext::FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) {
     VkPhysicalDeviceMemoryProperties memProperties;
     vkGetPhysicalDeviceMemoryProperties(m_physicalDevice, &memProperties);
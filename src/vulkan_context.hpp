@@ -2,6 +2,7 @@
 #include <xcb/xcb.h>
 #include <vulkan/vulkan.hpp>
 #include <vulkan/vulkan_xcb.h>
+#include <deque>
 #include <vector>
 #include <memory>
 #include "logger.hpp"
@@ -16,10 +17,48 @@ public:
     bool Initialize();
     void Cleanup();
 
+    VkInstance GetInstance() const { return m_instance; }
     VkDevice GetDevice() const { return m_device; }
     VkPhysicalDevice GetPhysicalDevice() const { return m_physicalDevice; }
     VkQueue GetComputeQueue() const { return m_computeQueue; }
     uint32_t GetComputeQueueFamily() const { return m_computeQueueFamily; }
+    const VkPhysicalDeviceProperties& GetDeviceProperties() const { return m_deviceProperties; }
+    const uint8_t* GetDeviceUUID() const { return m_deviceUUID; }
+    // 0 when the compute queue cannot write timestamps
+    uint32_t GetTimestampValidBits() const { return m_timestampValidBits; }
+    // Milliseconds between two timestamps of the compute queue, counting
+    // only their valid bits so a wrapped counter still gives the interval
+    double TimestampIntervalMs(uint64_t begin, uint64_t end) const;
+
+    bool HasPushDescriptors() const { return m_hasPushDescriptors; }
+    bool HasSwapchain() const { return m_hasSwapchain; }
+    bool HasStorageWriteWithoutFormat() const { return m_hasStorageWriteWithoutFormat; }
+    bool HasPresentWait() const { return m_hasPresentWait; }
+    bool HasSubgroupArithmetic() const { return m_hasSubgroupArithmetic; }
+    // Shaders are not built to vary it, so it is also their subgroup size
+    uint32_t GetSubgroupSize() const { return m_subgroupSize; }
+    VkResult WaitForPresent(VkSwapchainKHR swapchain, uint64_t presentId, uint64_t timeout) const;
+    bool HasExternalMemoryHost() const { return m_hasExternalMemoryHost; }
+    VkDeviceSize GetHostPointerAlignment() const { return m_hostPointerAlignment; }
+    bool GetMemoryHostPointerProperties(const void* pointer, uint32_t& memoryTypeBits) const;
+    void CmdPushDescriptorSetWithTemplate(VkCommandBuffer commandBuffer,
+                                          VkDescriptorUpdateTemplate updateTemplate,
+                                          VkPipelineLayout layout, uint32_t set,
+                                          const void* data) const;
+
+    // Asynchronous submissions to the compute queue go through Submit so
+    // CPU-side caches can tell when the GPU is done with what they recorded.
+    // Each one gets the next serial; commands recorded now belong to
+    // GetPendingSerial(), so no other asynchronous submission may happen
+    // while a command buffer that uses such caches is being recorded.
+    // fence must be valid. Submissions that are waited for right away need
+    // not be counted.
+    VkResult Submit(const VkSubmitInfo& submitInfo, VkFence fence);
+    uint64_t GetPendingSerial() const { return m_submittedSerial + 1; }
+    // Newest serial whose submission and all earlier ones have completed
+    uint64_t GetCompletedSerial();
+    // Owners call this after waiting for a fence and before destroying it
+    void ReleaseFence(VkFence fence);
 
     bool CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, 
                      VkMemoryPropertyFlags properties,
@@ -27,7 +66,9 @@ public:
 
     bool CreateImage(uint32_t width, uint32_t height, VkFormat format,
                     VkImageUsageFlags usage, VkMemoryPropertyFlags properties,
-                    VkImage& image, VkDeviceMemory& imageMemory);
+                    VkImage& image, VkDeviceMemory& imageMemory, uint32_t layers = 1);
+
+    bool SupportsMemoryProperties(VkMemoryPropertyFlags properties) const;
 
     void DestroyBuffer(VkBuffer buffer, VkDeviceMemory memory);
     void DestroyImage(VkImage image, VkDeviceMemory memory);
@@ -41,12 +82,38 @@ private:
     bool CreateLogicalDevice();
     uint32_t FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
     bool CheckValidationLayerSupport();
+    bool IsExtensionSupported(const std::vector<VkExtensionProperties>& available,
+                              const char* name) const;
 
     VkInstance m_instance = VK_NULL_HANDLE;
     VkPhysicalDevice m_physicalDevice = VK_NULL_HANDLE;
     VkDevice m_device = VK_NULL_HANDLE;
     VkQueue m_computeQueue = VK_NULL_HANDLE;
     uint32_t m_computeQueueFamily = 0;
+    uint32_t m_timestampValidBits = 0;
+    VkPhysicalDeviceProperties m_deviceProperties{};
+    uint8_t m_deviceUUID[VK_UUID_SIZE] = {};
+
+    bool m_hasPushDescriptors = false;
+    bool m_hasSurface = false;
+    bool m_hasSwapchain = false;
+    bool m_hasStorageWriteWithoutFormat = false;
+    bool m_hasPresentWait = false;
+    bool m_hasSubgroupArithmetic = false;
+    uint32_t m_subgroupSize = 1;
+    PFN_vkWaitForPresentKHR m_waitForPresent = nullptr;
+    bool m_hasExternalMemoryHost = false;
+    VkDeviceSize m_hostPointerAlignment = 0;
+    PFN_vkGetMemoryHostPointerPropertiesEXT m_getMemoryHostPointerProperties = nullptr;
+    PFN_vkCmdPushDescriptorSetWithTemplateKHR m_cmdPushDescriptorSetWithTemplate = nullptr;
+
+    struct Submission {
+        uint64_t serial;
+        VkFence fence;
+    };
+    uint64_t m_submittedSerial = 0;
+    // Oldest first
+    std::deque<Submission> m_inFlight;
 
     const std::vector<const char*> m_validationLayers = {
         "VK_LAYER_KHRONOS_validation"
@@ -469,41 +469,124 @@ bool WindowCapture::CaptureWaylandFrame(Frame& frame) {
     return false;
 }
  
+bool WindowCapture::CreateUploadSlots(VkDeviceSize size) {
+    auto& vulkan = VulkanContext::Get();
+    auto device = vulkan.GetDevice();
+
+    DestroyUploadSlots();
+
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.queueFamilyIndex = vulkan.GetComputeQueueFamily();
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+
+    if (vkCreateCommandPool(device, &poolInfo, nullptr, &m_uploadPool) != VK_SUCCESS) {
+        LOG_ERROR("Failed to create upload command pool");
+        return false;
+    }
+
+    m_uploadSlots.resize(kUploadSlots);
+    for (auto& slot : m_uploadSlots) {
+        if (!FrameManager::Get().CreateStagingBuffer(slot.buffer, slot.memory, size)) {
+            LOG_ERROR("Failed to create staging buffer");
+            DestroyUploadSlots();
+            return false;
+        }
+
+        if (vkMapMemory(device, slot.memory, 0, VK_WHOLE_SIZE, 0, &slot.mapped) != VK_SUCCESS) {
+            LOG_ERROR("Failed to map staging buffer memory");
+            DestroyUploadSlots();
+            return false;
+        }
+
+        VkCommandBufferAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.commandPool = m_uploadPool;
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInfo.commandBufferCount = 1;
+
+        VkFenceCreateInfo fenceInfo{};
+        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+        if (vkAllocateCommandBuffers(device, &allocInfo, &slot.commandBuffer) != VK_SUCCESS ||
+            vkCreateFence(device, &fenceInfo, nullptr, &slot.fence) != VK_SUCCESS) {
+            LOG_ERROR("Failed to create upload command buffer");
+            DestroyUploadSlots();
+            return false;
+        }
+    }
+
+    m_uploadSize = size;
+    return true;
+}
+
+void WindowCapture::DestroyUploadSlots() {
+    auto device = VulkanContext::Get().GetDevice();
+    if (!device) {
+        return;
+    }
+
+    for (auto& slot : m_uploadSlots) {
+        if (slot.pending) {
+            vkWaitForFences(device, 1, &slot.fence, VK_TRUE, UINT64_MAX);
+        }
+        if (slot.fence != VK_NULL_HANDLE) {
+            VulkanContext::Get().ReleaseFence(slot.fence);
+            vkDestroyFence(device, slot.fence, nullptr);
+        }
+        if (slot.mapped) {
+            vkUnmapMemory(device, slot.memory);
+        }
+        if (slot.buffer != VK_NULL_HANDLE) {
+            FrameManager::Get().DestroyStagingBuffer(slot.buffer, slot.memory);
+        }
+    }
+    m_uploadSlots.clear();
+
+    // Frees the slot command buffers with it
+    if (m_uploadPool != VK_NULL_HANDLE) {
+        vkDestroyCommandPool(device, m_uploadPool, nullptr);
+        m_uploadPool = VK_NULL_HANDLE;
+    }
+
+    m_uploadSize = 0;
+    m_nextUpload = 0;
+}
+
 bool WindowCapture::CopyToStagingBuffer(const void* data, size_t size, Frame& frame) {
-    // Create staging buffer
-    VkBuffer stagingBuffer;
-    VkDeviceMemory stagingMemory;
+    auto device = VulkanContext::Get().GetDevice();
     VkDeviceSize bufferSize = m_width * m_height * 4;
  
     if (size < bufferSize) {
         LOG_ERROR("Captured image size (", size, ") smaller than expected (", bufferSize, ")");
         return false;
     }
- 
-    if (!FrameManager::Get().CreateStagingBuffer(stagingBuffer, stagingMemory, bufferSize)) {
-        LOG_ERROR("Failed to create staging buffer");
-        return false;
-    }
- 
-    // Copy data to staging buffer
-    void* mappedData;
-    if (vkMapMemory(VulkanContext::Get().GetDevice(), stagingMemory, 0, bufferSize, 0, &mappedData) != VK_SUCCESS) {
-        LOG_ERROR("Failed to map staging buffer memory");
-        FrameManager::Get().DestroyStagingBuffer(stagingBuffer, stagingMemory);
-        return false;
-    }
- 
-    memcpy(mappedData, data, bufferSize);
-    vkUnmapMemory(VulkanContext::Get().GetDevice(), stagingMemory);
- 
-    // Copy staging buffer to frame
-    VkCommandBuffer commandBuffer = FrameManager::Get().BeginSingleTimeCommands();
-    if (!commandBuffer) {
-        LOG_ERROR("Failed to begin command buffer");
-        FrameManager::Get().DestroyStagingBuffer(stagingBuffer, stagingMemory);
+
+    // The window was resized: slots are only rebuilt then, not per capture
+    if (bufferSize != m_uploadSize && !CreateUploadSlots(bufferSize)) {
         return false;
     }
- 
+
+    // The upload is queued rather than waited for; only a slot whose
+    // previous upload is still in flight blocks, which leaves the GPU
+    // kUploadSlots captures of slack
+    UploadSlot& slot = m_uploadSlots[m_nextUpload];
+    if (slot.pending) {
+        vkWaitForFences(device, 1, &slot.fence, VK_TRUE, UINT64_MAX);
+        vkResetFences(device, 1, &slot.fence);
+        slot.pending = false;
+    }
+    m_nextUpload = (m_nextUpload + 1) % kUploadSlots;
+
+    memcpy(slot.mapped, data, bufferSize);
+
+    vkResetCommandBuffer(slot.commandBuffer, 0);
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(slot.commandBuffer, &beginInfo);
+
     VkBufferImageCopy region{};
     region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
     region.imageSubresource.layerCount = 1;
@@ -526,9 +609,12 @@ bool WindowCapture::CopyToStagingBuffer(const void* data, size_t size, Frame& fr
     barrier.srcAccessMask = 0;
     barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
  
+    // Frames still in flight may be sampling the image being overwritten.
+    // Everything runs on the compute queue, so these barriers also order
+    // the upload against earlier and later submissions without a wait.
     vkCmdPipelineBarrier(
-        commandBuffer,
-        VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+        slot.commandBuffer,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
         VK_PIPELINE_STAGE_TRANSFER_BIT,
         0,
         0, nullptr,
@@ -537,8 +623,8 @@ bool WindowCapture::CopyToStagingBuffer(const void* data, size_t size, Frame& fr
     );
  
     vkCmdCopyBufferToImage(
-        commandBuffer,
-        stagingBuffer,
+        slot.commandBuffer,
+        slot.buffer,
         frame.image,
         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
         1,
@@ -551,23 +637,37 @@ bool WindowCapture::CopyToStagingBuffer(const void* data, size_t size, Frame& fr
     barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
  
     vkCmdPipelineBarrier(
-        commandBuffer,
+        slot.commandBuffer,
         VK_PIPELINE_STAGE_TRANSFER_BIT,
-        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
         0,
         0, nullptr,
         0, nullptr,
         1, &barrier
     );
- 
-    FrameManager::Get().EndSingleTimeCommands(commandBuffer);
-    FrameManager::Get().DestroyStagingBuffer(stagingBuffer, stagingMemory);
- 
-    vkQueueWaitIdle(VulkanContext::Get().GetComputeQueue());
+
+    if (vkEndCommandBuffer(slot.commandBuffer) != VK_SUCCESS) {
+        LOG_ERROR("Failed to record upload command buffer");
+        return false;
+    }
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &slot.commandBuffer;
+
+    if (VulkanContext::Get().Submit(submitInfo, slot.fence) != VK_SUCCESS) {
+        LOG_ERROR("Failed to submit frame upload");
+        return false;
+    }
+    slot.pending = true;
+
+    frame.serial = ++m_captureSerial;
     return true;
 }
  
 void WindowCapture::Cleanup() {
+    DestroyUploadSlots();
     CleanupSharedMemory();
     
     if (m_connection) {
@@ -9,6 +9,7 @@
 #include <sys/shm.h>
 #include "logger.hpp"
 #include "frame_manager.hpp"
+#include <vector>
  
 enum class DisplayServer {
     X11,
@@ -31,8 +32,13 @@ public:
     }
  
     bool Initialize(uint32_t windowId);
+    // Releases Vulkan resources too, so it runs before VulkanContext::Cleanup
     void Cleanup();
  
+    // X11 and wl_shm both hand out little-endian XRGB pixels, so captured
+    // frames are BGRA and sample as correct RGB
+    static constexpr VkFormat kFrameFormat = VK_FORMAT_B8G8R8A8_UNORM;
+
     bool CaptureFrame(Frame& frame);
     bool GetWindowSize(uint32_t& width, uint32_t& height);
  
@@ -62,6 +68,8 @@ private:
     bool SetupSharedMemory(uint32_t size);
     void CleanupSharedMemory();
     bool CopyToStagingBuffer(const void* data, size_t size, Frame& frame);
+    bool CreateUploadSlots(VkDeviceSize size);
+    void DestroyUploadSlots();
  
     DisplayServer m_displayServer = DisplayServer::X11;
  
@@ -89,6 +97,25 @@ private:
     void* m_shmData = nullptr;
     int m_shmId = -1;
  
+    // Persistently mapped staging buffers, each reused once its fence says
+    // the previous upload from it has finished
+    struct UploadSlot {
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        void* mapped = nullptr;
+        VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+        VkFence fence = VK_NULL_HANDLE;
+        bool pending = false;
+    };
+    static constexpr uint32_t kUploadSlots = 2;
+    VkCommandPool m_uploadPool = VK_NULL_HANDLE;
+    std::vector<UploadSlot> m_uploadSlots;
+    VkDeviceSize m_uploadSize = 0;
+    uint32_t m_nextUpload = 0;
+
+    // Content serial of the last captured frame
+    uint64_t m_captureSerial = 0;
+ 
     // Wayland resources
     WaylandContext m_wayland;
 };
\ No newline at end of file